@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace engine {
+
+// Monotonic per-job memory: engine objects built on resource() allocate without locking and
+// everything is returned to the upstream in one release(). The objects must not outlive it.
+class arena final
+{
+public:
+    static constexpr size_t DEFAULT_SIZE = 64 * 1024;
+
+public:
+    explicit arena(const size_t initial_size = DEFAULT_SIZE,
+                   std::pmr::memory_resource* p_upstream = std::pmr::get_default_resource())
+        : m_resource(initial_size, p_upstream)
+    {}
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    void release() { m_resource.release(); }
+
+    std::pmr::memory_resource* resource() { return &m_resource; }
+
+private:
+    std::pmr::monotonic_buffer_resource m_resource;
+};
+
+} // namespace engine
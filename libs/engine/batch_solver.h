@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "engine/board.h"
+#include "engine/budget.h"
+#include "engine/solver.h"
+
+namespace engine {
+
+// Bulk solving: the candidates of LANES puzzles are kept as structure of arrays, one 16-bit mask
+// per cell and puzzle, and naked and hidden singles run on all of them in lockstep. Puzzles left
+// unsolved by the singles are finished by the scalar solver.
+class batch_solver final
+{
+public:
+    using grid_t = board::grid_t;
+
+    // 16 masks of 16 bits fill one AVX2 register.
+    static constexpr size_t LANES = 16;
+
+public:
+    // Solves the grids in place, p_results[i] is SUCCESS or FAILURE for grid i.
+    void solve(grid_t* p_grids, const size_t count, search_result* p_results);
+
+    // Puzzles finished by the lockstep singles and puzzles handed to the solver.
+    size_t propagated() const { return m_propagated; }
+    size_t searched() const { return m_searched; }
+
+    // Whether the singles run on the AVX2 or AVX-512 build of the kernel.
+    static bool is_avx2_enabled();
+
+private:
+    using mask_t = uint16_t;
+    using lanes_t = std::array<mask_t, LANES>;
+    using cells_t = std::array<lanes_t, board::BOARD_SIZE>;
+
+private:
+    void solve_batch(grid_t* p_grids, const size_t count, search_result* p_results);
+
+private:
+    alignas(32) cells_t m_cells;
+    solver m_solver;
+
+    size_t m_propagated = 0;
+    size_t m_searched = 0;
+};
+
+} // namespace engine
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "engine/board.h"
+#include "engine/budget.h"
+
+namespace engine {
+
+// Backend with the solver and checker semantics on a bitboard: the places left for every digit
+// are three 27-bit band words, so placing a digit clears its row, box and column with a few
+// table masks, and singles are found for whole bands at once.
+class bitboard_solver final
+{
+public:
+    using grid_t = board::grid_t;
+
+public:
+    bitboard_solver() = default;
+    explicit bitboard_solver(grid_t grid);
+
+    grid_t get_grid() const { return m_grid; }
+
+    void reset(grid_t grid) { m_grid = std::move(grid); }
+
+    bool solve();
+    bool solve(grid_t grid);
+
+    search_result solve(budget& b);
+    search_result solve(grid_t grid, budget& b);
+
+    // Solutions up to limit, like details::checker; the first one is kept as the grid.
+    size_t count_solutions(const size_t limit = 2);
+    search_result count_solutions(const grid_t& g, budget& b, size_t& count, const size_t limit = 2);
+
+    static bool can_solve(const grid_t& g);
+    static search_result can_solve(const grid_t& g, budget& b);
+
+    static size_t calc_solutions(const grid_t& g, const size_t limit = 2);
+
+private:
+    // Per-thread context behind the static helpers.
+    static bitboard_solver& local();
+
+    // The search is built per instruction set level, see details/cpu_dispatch.h.
+    size_t run(const size_t limit);
+
+private:
+    grid_t m_grid = {};
+    budget* m_p_budget = nullptr;
+};
+
+} // namespace engine
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <array>
+#include <bitset>
 
 namespace engine {
 
@@ -15,8 +17,10 @@ public:
 
     using value_t = char;
     using tag_t = int;
+    using hash_t = uint64_t;
     using row_t = std::array<value_t, COL_SIZE>;
     using grid_t = std::array<row_t, ROW_SIZE>;
+    using conflicts_t = std::bitset<BOARD_SIZE>;
 
     static constexpr tag_t DEFAULT_TAG = 0;
     static constexpr tag_t BEGIN_TAG = 1;
@@ -30,12 +34,24 @@ public:
 
     const grid_t& grid() const { return m_grid; }
 
+    // Zobrist hash of the placed values, kept up to date by set_value() and rollbacks.
+    hash_t hash() const { return m_hash; }
+
     bool is_available(const size_t p, const value_t v) const;
     bool is_possible(const size_t p, const value_t v) const;
 
-    bool is_set_value(const size_t p) const { return (m_grid[to_row(p)][to_col(p)] != 0); }
+    bool is_set_value(const size_t p) const { return (m_ch_grid[p] != INVALID_TAG); }
 
     void reset(grid_t g);
+    // Loads the cells from any storage with get(p), without building a grid first.
+    template<typename TStorage>
+    void reset_from(const TStorage& s)
+    {
+        for (size_t p = 0; p < BOARD_SIZE; ++p) {
+            m_grid[to_row(p)][to_col(p)] = s.get(p);
+        }
+        init();
+    }
 
     void rollback(const tag_t t);
 
@@ -47,30 +63,38 @@ public:
 
     value_t value(const size_t p) const { return m_grid[to_row(p)][to_col(p)]; }
 
+    static bool is_valid(const grid_t& g) { return validate(g).none(); }
+
     static tag_t max_tag(const board& b) { return b.max_tag(); }
 
+    // Cells whose digit repeats in their row, column or box, and cells holding no digit 0-9.
+    static conflicts_t validate(const grid_t& g);
+
 private:
     void init();
 
-    tag_t max_tag() const;
+    tag_t max_tag() const { return m_max_tag; }
 
     static size_t to_col(const size_t p);
 
     static size_t to_row(const size_t p);
 
 private:
-    using change_row_t = std::array<tag_t, COL_SIZE>;
-    using change_grid_t = std::array<change_row_t, ROW_SIZE>;
+    using change_grid_t = std::array<tag_t, BOARD_SIZE>;
 
     using poss_value_t = std::array<tag_t, GRID_SIZE * GRID_SIZE>;
-    using poss_row_t = std::array<poss_value_t, COL_SIZE>;
-    using poss_grid_t = std::array<poss_row_t, ROW_SIZE>;
+    using poss_grid_t = std::array<poss_value_t, BOARD_SIZE>;
 
 private:
     grid_t m_grid;
 
     poss_grid_t m_possible;
     change_grid_t m_ch_grid;
+
+    // Highest tag of both placed values and eliminations, so rollbacks never miss an elimination.
+    tag_t m_max_tag = DEFAULT_TAG;
+
+    hash_t m_hash = 0;
 };
 
 } // namespace engine
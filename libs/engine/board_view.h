@@ -1,38 +1,192 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <array>
+#include <type_traits>
 
 #include "engine/board.h"
+#include "engine/details/tables.h"
 
 namespace engine {
 
-class board_view final
+// Storage policies of basic_board_view: get() and set() of cell p in row-major order, grid()
+// copies the cells out. The views do not own the memory behind them. Each storage is a template
+// over its element type: the const instantiations read external buffers in place and have no set().
+// Characters and nibbles that are not digits read as values out of range, which the board leaves
+// unmarked and validate() reports.
+
+namespace details {
+
+template<typename TElem>
+using enable_if_mutable_t = std::enable_if_t<! std::is_const_v<TElem>, int>;
+
+} // namespace details
+
+template<typename TGrid>
+class basic_grid_storage final
 {
 public:
     using value_t = board::value_t;
-    using tag_t = board::tag_t;
-    using row_t = board::row_t;
     using grid_t = board::grid_t;
 
 public:
-    explicit board_view(grid_t& g);
+    basic_grid_storage(TGrid& g)
+        : m_p_grid(&g)
+    {}
+
+    value_t get(const size_t p) const { return (*m_p_grid)[details::CELL_ROW[p]][details::CELL_COL[p]]; }
 
     const grid_t& grid() const { return *m_p_grid; }
 
-    bool is_set_value(const size_t p) const;
+    template<typename TElem = TGrid, details::enable_if_mutable_t<TElem> = 0>
+    void set(const size_t p, const value_t v) { (*m_p_grid)[details::CELL_ROW[p]][details::CELL_COL[p]] = v; }
+
+private:
+    TGrid* m_p_grid;
+};
+
+// 81 characters, '0' or '.' for an empty cell; set() writes blank for zero.
+template<typename TChar>
+class basic_text_storage final
+{
+public:
+    using value_t = board::value_t;
+    using grid_t = board::grid_t;
+
+public:
+    explicit basic_text_storage(TChar* p_text, const char blank = '0')
+        : m_p_text(p_text)
+        , m_blank(blank)
+    {}
+
+    value_t get(const size_t p) const { return (m_p_text[p] == '.') ? 0 : static_cast<value_t>(m_p_text[p] - '0'); }
 
-    void set_value(const size_t p, const value_t v);
+    grid_t grid() const;
 
-    value_t value(const size_t p) const;
+    template<typename TElem = TChar, details::enable_if_mutable_t<TElem> = 0>
+    void set(const size_t p, const value_t v) { m_p_text[p] = (v == 0) ? m_blank : static_cast<char>('0' + v); }
 
 private:
-    static size_t to_col(const size_t p);
-    static size_t to_row(const size_t p);
+    TChar* m_p_text;
+    char m_blank;
+};
+
+// Two cells per byte, low nibble first: 41 bytes for a grid.
+template<typename TByte>
+class basic_nibble_storage final
+{
+public:
+    using value_t = board::value_t;
+    using grid_t = board::grid_t;
+
+    static constexpr size_t SIZE = (board::BOARD_SIZE + 1) / 2;
+
+public:
+    explicit basic_nibble_storage(TByte* p_bytes)
+        : m_p_bytes(p_bytes)
+    {}
+
+    value_t get(const size_t p) const { return static_cast<value_t>((m_p_bytes[p / 2] >> shift(p)) & 0x0f); }
+
+    grid_t grid() const;
+
+    template<typename TElem = TByte, details::enable_if_mutable_t<TElem> = 0>
+    void set(const size_t p, const value_t v)
+    {
+        m_p_bytes[p / 2] = static_cast<uint8_t>((m_p_bytes[p / 2] & ~(0x0f << shift(p))) | (v << shift(p)));
+    }
+
+private:
+    static size_t shift(const size_t p) { return 4 * (p % 2); }
 
 private:
-    grid_t* m_p_grid;
+    TByte* m_p_bytes;
 };
 
-} // namespace engine
+// Digits at p_base[r * row_stride + c * col_stride], a grid inside a wider matrix or a column of
+// records, for example.
+template<typename TValue>
+class basic_strided_storage final
+{
+public:
+    using value_t = board::value_t;
+    using grid_t = board::grid_t;
+
+public:
+    basic_strided_storage(TValue* p_base, const size_t row_stride, const size_t col_stride = 1)
+        : m_p_base(p_base)
+        , m_row_stride(row_stride)
+        , m_col_stride(col_stride)
+    {}
+
+    value_t get(const size_t p) const { return m_p_base[offset(p)]; }
+
+    grid_t grid() const;
+
+    template<typename TElem = TValue, details::enable_if_mutable_t<TElem> = 0>
+    void set(const size_t p, const value_t v) { m_p_base[offset(p)] = v; }
+
+private:
+    size_t offset(const size_t p) const
+    {
+        return details::CELL_ROW[p] * m_row_stride + details::CELL_COL[p] * m_col_stride;
+    }
+
+private:
+    TValue* m_p_base;
+    size_t m_row_stride;
+    size_t m_col_stride;
+};
+
+using grid_storage = basic_grid_storage<board::grid_t>;
+using text_storage = basic_text_storage<char>;
+using nibble_storage = basic_nibble_storage<uint8_t>;
+using strided_storage = basic_strided_storage<board::value_t>;
+
+using const_grid_storage = basic_grid_storage<const board::grid_t>;
+using const_text_storage = basic_text_storage<const char>;
+using const_nibble_storage = basic_nibble_storage<const uint8_t>;
+using const_strided_storage = basic_strided_storage<const board::value_t>;
+
+template<typename TStorage>
+class basic_board_view final
+{
+public:
+    using value_t = board::value_t;
+    using tag_t = board::tag_t;
+    using row_t = board::row_t;
+    using grid_t = board::grid_t;
+    using storage_t = TStorage;
+
+public:
+    explicit basic_board_view(TStorage s)
+        : m_storage(s)
+    {}
+
+    // A reference for grid_storage, a copy for the other storages.
+    decltype(auto) grid() const { return m_storage.grid(); }
+
+    bool is_set_value(const size_t p) const { return (value(p) != 0); }
+
+    void set_value(const size_t p, const value_t v) { m_storage.set(p, v); }
 
+    const TStorage& storage() const { return m_storage; }
+
+    value_t value(const size_t p) const { return m_storage.get(p); }
+
+private:
+    TStorage m_storage;
+};
+
+using board_view = basic_board_view<grid_storage>;
+using text_board_view = basic_board_view<text_storage>;
+using nibble_board_view = basic_board_view<nibble_storage>;
+using strided_board_view = basic_board_view<strided_storage>;
+
+using const_board_view = basic_board_view<const_grid_storage>;
+using const_text_board_view = basic_board_view<const_text_storage>;
+using const_nibble_board_view = basic_board_view<const_nibble_storage>;
+using const_strided_board_view = basic_board_view<const_strided_storage>;
+
+} // namespace engine
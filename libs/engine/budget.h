@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace engine {
+
+enum class search_result
+{
+    SUCCESS,
+    FAILURE,
+    BUDGET_EXCEEDED
+};
+
+class budget final
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+    using duration_t = clock_t::duration;
+    using time_point_t = clock_t::time_point;
+
+    static constexpr size_t UNLIMITED_NODES = std::numeric_limits<size_t>::max();
+
+    // The clock is polled on the first node and then once per CLOCK_CHECK_INTERVAL nodes to keep
+    // spend() cheap, so a deadline already passed fails short searches too.
+    static constexpr size_t CLOCK_CHECK_INTERVAL = 256;
+
+public:
+    budget() = default;
+
+    explicit budget(const size_t max_nodes)
+        : m_max_nodes(max_nodes)
+    {}
+
+    explicit budget(const duration_t timeout, const size_t max_nodes = UNLIMITED_NODES)
+        : m_max_nodes(max_nodes)
+        , m_deadline(clock_t::now() + timeout)
+        , m_has_deadline(true)
+    {}
+
+    budget(const time_point_t deadline, const size_t max_nodes)
+        : m_max_nodes(max_nodes)
+        , m_deadline(deadline)
+        , m_has_deadline(true)
+    {}
+
+    bool is_cancelled() const
+    {
+        return ((m_p_cancel != nullptr) && m_p_cancel->load(std::memory_order_relaxed))
+            || ((m_p_parent != nullptr) && m_p_parent->is_cancelled());
+    }
+
+    bool is_exceeded() const { return m_is_exceeded; }
+
+    size_t nodes() const { return m_nodes; }
+
+    // The flag is owned by the caller and may be raised from another thread.
+    void set_cancel_flag(const std::atomic<bool>* p_cancel) { m_p_cancel = p_cancel; }
+
+    // Budget of one of parts searches run in parallel under this one: the nodes left are split
+    // evenly, so together they never spend more, the deadline is shared, and cancelling this budget
+    // cancels the share as well. The share polls this budget, which must outlive it; its own cancel
+    // flag is unset and its nodes are not added back.
+    budget share(const size_t parts) const
+    {
+        budget res = *this;
+        res.m_nodes = 0;
+        if (m_max_nodes != UNLIMITED_NODES) {
+            const size_t left = (m_nodes < m_max_nodes) ? m_max_nodes - m_nodes : 0;
+            res.m_max_nodes = left / std::max<size_t>(parts, 1);
+        }
+        res.m_p_cancel = nullptr;
+        res.m_p_parent = this;
+        return res;
+    }
+
+    bool spend()
+    {
+        ++m_nodes;
+        if (m_nodes > m_max_nodes) {
+            m_is_exceeded = true;
+        } else if (is_cancelled()) {
+            m_is_exceeded = true;
+        } else if (m_has_deadline && (m_nodes % CLOCK_CHECK_INTERVAL == 1) && (clock_t::now() >= m_deadline)) {
+            m_is_exceeded = true;
+        }
+        return (! m_is_exceeded);
+    }
+
+private:
+    size_t m_nodes = 0;
+    size_t m_max_nodes = UNLIMITED_NODES;
+    time_point_t m_deadline;
+    bool m_has_deadline = false;
+    bool m_is_exceeded = false;
+
+    const std::atomic<bool>* m_p_cancel = nullptr;
+    const budget* m_p_parent = nullptr;
+};
+
+} // namespace engine
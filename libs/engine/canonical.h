@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+
+// Element of the Sudoku symmetry group: an optional transposition, row and column orders that keep
+// bands and stacks together, and a relabeling of the digits.
+struct transform final
+{
+    using grid_t = board::grid_t;
+    using value_t = board::value_t;
+    using lines_t = std::array<uint8_t, board::ROW_SIZE>;
+    using digits_t = std::array<value_t, board::END_VALUE>;
+
+    bool is_transposed = false;
+    // Line i of the result is line rows[i] (cols[i]) of the source, transposed first if required.
+    lines_t rows = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    lines_t cols = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    // Digit v of the source becomes digits[v], empty cells stay empty.
+    digits_t digits = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    grid_t apply(const grid_t& g) const;
+
+    // Inverse of apply(), maps a canonical grid (a solution, say) back to the source layout.
+    grid_t revert(const grid_t& g) const;
+};
+
+struct canonical_form final
+{
+    board::grid_t grid;
+    transform trans;
+    board::hash_t hash = 0;
+};
+
+// Minlex form: the lexicographically smallest row-major image of a grid under the symmetry group,
+// empty cells first. Rows are chosen one at a time and only the images tied on the prefix survive.
+class canonicalizer final
+{
+public:
+    using grid_t = board::grid_t;
+
+    // Images tied after the first row, beyond that the survivors are truncated. Only grids with
+    // a handful of givens get there; their form stays valid but may differ between presentations.
+    static constexpr size_t MAX_CANDIDATES = 2 * board::ROW_SIZE * details::LINE_PERMUTATIONS_COUNT;
+
+public:
+    explicit canonicalizer(std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    canonical_form canonicalize(const grid_t& g);
+
+    // Runs canonicalize() on a per-thread context.
+    static canonical_form calc(const grid_t& g);
+
+private:
+    struct candidate final
+    {
+        // Source lines of the canonical rows chosen so far.
+        transform::lines_t rows = {};
+        transform::digits_t labels = {};
+        uint16_t cols = 0;
+        board::value_t next_label = board::BEGIN_VALUE;
+        bool is_transposed = false;
+    };
+
+    using candidates_t = std::pmr::vector<candidate>;
+
+private:
+    void extend(const board::row_t& src, candidate c, board::row_t& best, bool& has_best);
+
+private:
+    candidates_t m_candidates;
+    candidates_t m_next;
+};
+
+} // namespace engine
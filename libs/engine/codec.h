@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "engine/board.h"
+
+namespace engine {
+
+// Packed records for archives.
+//
+// A puzzle is an 81-bit clue bitmap (bit p % 8 of byte p / 8 marks a given in cell p) followed by
+// the givens in cell order, two 4-bit digits per byte, low nibble first. The record size follows
+// from the bitmap: 11 bytes plus one byte per two givens.
+//
+// A solution stores rows 0-7 as the Lehmer codes of their permutations, 19 bits each (9! < 2^19),
+// in a little-endian bit stream; row 8 is restored from the columns.
+class codec final
+{
+public:
+    using grid_t = board::grid_t;
+
+    static constexpr size_t BITMAP_SIZE = (board::BOARD_SIZE + 7) / 8;
+    static constexpr size_t MAX_PUZZLE_SIZE = BITMAP_SIZE + (board::BOARD_SIZE + 1) / 2;
+    static constexpr size_t ROW_CODE_BITS = 19;
+    static constexpr size_t SOLUTION_SIZE = ((board::ROW_SIZE - 1) * ROW_CODE_BITS + 7) / 8;
+
+    using puzzle_t = std::array<uint8_t, MAX_PUZZLE_SIZE>;
+    using solution_t = std::array<uint8_t, SOLUTION_SIZE>;
+
+public:
+    // Returns the record size; the grid must hold digits 0-9 only.
+    static size_t encode_puzzle(const grid_t& g, puzzle_t& rec);
+
+    // Returns the bytes consumed, zero if size is short or a given is not a digit 1-9.
+    static size_t decode_puzzle(const uint8_t* p_rec, const size_t size, grid_t& g);
+
+    // Size of the record starting with the bitmap p_bitmap.
+    static size_t puzzle_size(const uint8_t* p_bitmap);
+
+    // The grid must be solved.
+    static solution_t encode_solution(const grid_t& g);
+
+    // False, with g unchanged, if a row code is out of range, the columns leave no digit for
+    // row 8 or a box repeats a digit.
+    static bool decode_solution(const solution_t& rec, grid_t& g);
+};
+
+} // namespace engine
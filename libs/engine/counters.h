@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <string>
+
+// Hot path event counters, compiled in with the SUDOKU_ENGINE_COUNTERS option. Without it the
+// ENGINE_COUNT macros expand to nothing and counters::local() stays zero.
+#if defined(SUDOKU_ENGINE_COUNTERS)
+    #define ENGINE_COUNT(field) (++::engine::counters::local().field)
+    #define ENGINE_COUNT_IF(field, cond) (::engine::counters::local().field += (cond) ? 1 : 0)
+    #define ENGINE_COUNT_TECHNIQUE(id) (++::engine::counters::local().technique_hits[static_cast<size_t>(id)])
+    #define ENGINE_COUNT_DEPTH() const ::engine::counters::depth_guard engine_depth_guard
+#else
+    #define ENGINE_COUNT(field) ((void)0)
+    #define ENGINE_COUNT_IF(field, cond) ((void)0)
+    #define ENGINE_COUNT_TECHNIQUE(id) ((void)0)
+    #define ENGINE_COUNT_DEPTH() ((void)0)
+#endif
+
+namespace engine {
+
+enum class technique_id
+{
+    SINGLE_CELL,
+    SINGLE_VALUE_COL,
+    SINGLE_VALUE_ROW,
+    SINGLE_VALUE_SECTION,
+    NAKED_PAIRS,
+    HIDDEN_PAIRS_COL,
+    HIDDEN_PAIRS_ROW,
+    TEMPLATES
+};
+
+struct counters final
+{
+#if defined(SUDOKU_ENGINE_COUNTERS)
+    static constexpr bool IS_ENABLED = true;
+#else
+    static constexpr bool IS_ENABLED = false;
+#endif
+
+    static constexpr size_t TECHNIQUES_COUNT = static_cast<size_t>(technique_id::TEMPLATES) + 1;
+
+    // Calls of board::set_value() and board::set_impossible(), effective or not.
+    size_t set_values = 0;
+    size_t set_impossibles = 0;
+
+    // board::rollback_to_tag() calls and the placements and eliminations they undo.
+    size_t rollbacks = 0;
+    size_t undone = 0;
+
+    // Cells picked by details::find_guess_cell().
+    size_t guesses = 0;
+
+    // Deepest nesting of the recursive searches.
+    size_t max_depth = 0;
+
+    std::array<size_t, TECHNIQUES_COUNT> technique_hits = {};
+
+    // Sums the counts, keeps the larger depth.
+    counters& operator+=(const counters& other);
+
+    std::string to_json() const;
+
+    // This thread's counters.
+    static counters& local();
+    static void reset();
+
+    static std::string technique_to_str(const technique_id id);
+
+    // Tracks the nesting of the search functions, see ENGINE_COUNT_DEPTH.
+    class depth_guard final
+    {
+    public:
+        depth_guard();
+        ~depth_guard();
+
+        depth_guard(const depth_guard&) = delete;
+        depth_guard& operator=(const depth_guard&) = delete;
+    };
+};
+
+} // namespace engine
@@ -0,0 +1,188 @@
+#include <algorithm>
+
+#include "engine/batch_solver.h"
+#include "engine/details/cpu_dispatch.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+namespace {
+
+using mask_t = uint16_t;
+using lanes_t = std::array<mask_t, batch_solver::LANES>;
+using cells_t = std::array<lanes_t, board::BOARD_SIZE>;
+using kernel_fn_t = void (*)(cells_t&);
+
+constexpr mask_t ALL_DIGITS = (1u << board::ROW_SIZE) - 1;
+
+// All lanes at once and without branches on the masks, so every loop over lanes maps to vector
+// operations. Empty (contradicted) cells are left in place and reported by the caller.
+ENGINE_KERNEL_INLINE void propagate_lanes(cells_t& cells)
+{
+    bool is_changed = true;
+    while (is_changed) {
+        lanes_t changed = {};
+
+        // Naked singles: a cell with one candidate removes it from its peers.
+        for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+            lanes_t single;
+            for (size_t l = 0; l < batch_solver::LANES; ++l) {
+                const mask_t m = cells[p][l];
+                single[l] = m & static_cast<mask_t>(0 - static_cast<mask_t>((m & (m - 1)) == 0));
+            }
+            for (const details::cell_idx_t q : details::PEERS[p]) {
+                for (size_t l = 0; l < batch_solver::LANES; ++l) {
+                    const mask_t m = cells[q][l];
+                    const mask_t next = m & static_cast<mask_t>(~single[l]);
+                    changed[l] |= m ^ next;
+                    cells[q][l] = next;
+                }
+            }
+        }
+
+        // Hidden singles: a digit with one place left in a unit is set there.
+        for (const details::unit_cells_t& unit : details::UNIT_CELLS) {
+            lanes_t once = {};
+            lanes_t twice = {};
+            for (const details::cell_idx_t p : unit) {
+                for (size_t l = 0; l < batch_solver::LANES; ++l) {
+                    twice[l] |= once[l] & cells[p][l];
+                    once[l] |= cells[p][l];
+                }
+            }
+            for (const details::cell_idx_t p : unit) {
+                for (size_t l = 0; l < batch_solver::LANES; ++l) {
+                    const mask_t m = cells[p][l];
+                    const mask_t hidden = m & static_cast<mask_t>(~twice[l]);
+                    const mask_t next = hidden | (m & static_cast<mask_t>(0 - static_cast<mask_t>(hidden == 0)));
+                    changed[l] |= m ^ next;
+                    cells[p][l] = next;
+                }
+            }
+        }
+
+        mask_t any = 0;
+        for (size_t l = 0; l < batch_solver::LANES; ++l) {
+            any |= changed[l];
+        }
+        is_changed = (any != 0);
+    }
+}
+
+void propagate_generic(cells_t& cells)
+{
+    propagate_lanes(cells);
+}
+
+#if defined(ENGINE_CPU_DISPATCH)
+ENGINE_TARGET_AVX2 void propagate_avx2(cells_t& cells)
+{
+    propagate_lanes(cells);
+}
+
+ENGINE_TARGET_AVX512 void propagate_avx512(cells_t& cells)
+{
+    propagate_lanes(cells);
+}
+#endif
+
+#if defined(ENGINE_CPU_DISPATCH)
+constexpr details::kernel_table_t<kernel_fn_t> KERNELS = {
+    propagate_generic, propagate_generic, propagate_avx2, propagate_avx512
+};
+#else
+constexpr details::kernel_table_t<kernel_fn_t> KERNELS = {
+    propagate_generic, propagate_generic, propagate_generic, propagate_generic
+};
+#endif
+
+board::value_t to_value(const mask_t single)
+{
+    board::value_t v = board::BEGIN_VALUE;
+    for (mask_t m = single; m > 1; m >>= 1) {
+        ++v;
+    }
+    return v;
+}
+
+} // <anonymous> namespace
+
+bool batch_solver::is_avx2_enabled()
+{
+    return (details::active_isa_level() >= details::isa_level::AVX2);
+}
+
+void batch_solver::solve(grid_t* p_grids, const size_t count, search_result* p_results)
+{
+    for (size_t begin = 0; begin < count; begin += LANES) {
+        solve_batch(p_grids + begin, std::min(LANES, count - begin), p_results + begin);
+    }
+}
+
+void batch_solver::solve_batch(grid_t* p_grids, const size_t count, search_result* p_results)
+{
+    const kernel_fn_t kernel = details::select_kernel(KERNELS);
+
+    // Lanes past count and invalid grids stay all-candidates, the singles leave them unchanged.
+    std::array<bool, LANES> is_valid = {};
+    for (lanes_t& cell : m_cells) {
+        cell.fill(ALL_DIGITS);
+    }
+    for (size_t l = 0; l < count; ++l) {
+        is_valid[l] = board::is_valid(p_grids[l]);
+        if (! is_valid[l]) {
+            continue;
+        }
+        for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+            const board::value_t v = p_grids[l][details::CELL_ROW[p]][details::CELL_COL[p]];
+            if (v != 0) {
+                m_cells[p][l] = static_cast<mask_t>(1u << (v - 1));
+            }
+        }
+    }
+
+    kernel(m_cells);
+
+    for (size_t l = 0; l < count; ++l) {
+        p_results[l] = search_result::FAILURE;
+        if (! is_valid[l]) {
+            continue;
+        }
+
+        bool is_failed = false;
+        bool is_solved = true;
+        for (const details::unit_cells_t& unit : details::UNIT_CELLS) {
+            mask_t digits = 0;
+            for (const details::cell_idx_t p : unit) {
+                const mask_t m = m_cells[p][l];
+                digits |= m;
+                is_failed = is_failed || (m == 0);
+                is_solved = is_solved && ((m & (m - 1)) == 0);
+            }
+            is_failed = is_failed || (digits != ALL_DIGITS);
+        }
+        if (is_failed) {
+            continue;
+        }
+
+        // Singles found by the lanes are implied by the givens, so the solver starts from them.
+        grid_t reduced;
+        for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+            const mask_t m = m_cells[p][l];
+            reduced[details::CELL_ROW[p]][details::CELL_COL[p]] = ((m & (m - 1)) == 0) ? to_value(m) : 0;
+        }
+        if (is_solved) {
+            ++m_propagated;
+            p_grids[l] = reduced;
+            p_results[l] = search_result::SUCCESS;
+            continue;
+        }
+
+        ++m_searched;
+        if (m_solver.solve(reduced)) {
+            p_grids[l] = m_solver.get_grid();
+            p_results[l] = search_result::SUCCESS;
+        }
+    }
+}
+
+} // namespace engine
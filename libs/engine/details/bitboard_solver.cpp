@@ -0,0 +1,372 @@
+#include <array>
+
+#include "engine/bitboard_solver.h"
+#include "engine/counters.h"
+#include "engine/details/cpu_dispatch.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+namespace {
+
+using band_mask_t = details::band_mask_t;
+
+constexpr size_t BANDS = details::BANDS_COUNT;
+constexpr size_t DIGITS = board::ROW_SIZE;
+
+struct state final
+{
+    // Places of digit d in band b at [d * BANDS + b]; placed cells keep their bit.
+    std::array<band_mask_t, DIGITS * BANDS> digits;
+    std::array<band_mask_t, BANDS> unsolved;
+};
+
+struct search_context final
+{
+    bool is_budget_exceeded() const { return (p_budget != nullptr) && p_budget->is_exceeded(); }
+
+    bool spend_node() { return (p_budget == nullptr) || p_budget->spend(); }
+
+    budget* p_budget = nullptr;
+    size_t limit = 0;
+    size_t solutions_count = 0;
+    state solution;
+};
+
+ENGINE_KERNEL_INLINE bool is_single(const band_mask_t m) { return (m & (m - 1)) == 0; }
+
+ENGINE_KERNEL_INLINE size_t lowest_bit(const band_mask_t m)
+{
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctz(m));
+#else
+    size_t bit = 0;
+    while (((m >> bit) & 1) == 0) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+ENGINE_KERNEL_INLINE bool assign(state& s, const size_t band, const size_t bit, const size_t digit)
+{
+    const band_mask_t cell = band_mask_t(1) << bit;
+    band_mask_t* p_digit = &s.digits[digit * BANDS];
+    if ((p_digit[band] & cell) == 0) {
+        return false;
+    }
+
+    for (size_t d = 0; d < DIGITS; ++d) {
+        s.digits[d * BANDS + band] &= ~cell;
+    }
+    p_digit[band] = (p_digit[band] & ~details::BAND_PEERS[bit]) | cell;
+    const band_mask_t col = details::BAND_COLS[details::CELL_COL[bit]];
+    for (size_t b = 0; b < BANDS; ++b) {
+        if (b != band) {
+            p_digit[b] &= ~col;
+        }
+    }
+    s.unsolved[band] &= ~cell;
+    return true;
+}
+
+ENGINE_KERNEL_INLINE bool propagate(state& s)
+{
+    bool is_placed = true;
+    while (is_placed) {
+        is_placed = false;
+
+        // Naked singles: candidates per cell are counted bit-sliced over the digits, a band at once.
+        for (size_t b = 0; b < BANDS; ++b) {
+            if (s.unsolved[b] == 0) {
+                continue;
+            }
+            band_mask_t once = 0;
+            band_mask_t twice = 0;
+            for (size_t d = 0; d < DIGITS; ++d) {
+                twice |= once & s.digits[d * BANDS + b];
+                once |= s.digits[d * BANDS + b];
+            }
+            if ((s.unsolved[b] & ~once) != 0) {
+                return false;
+            }
+
+            band_mask_t singles = s.unsolved[b] & ~twice;
+            while (singles != 0) {
+                const size_t bit = lowest_bit(singles);
+                singles &= singles - 1;
+
+                // An earlier single of this pass may have taken the last candidate.
+                size_t d = 0;
+                while ((d < DIGITS) && ((s.digits[d * BANDS + b] & (band_mask_t(1) << bit)) == 0)) {
+                    ++d;
+                }
+                if ((d == DIGITS) || (! assign(s, b, bit, d))) {
+                    return false;
+                }
+                is_placed = true;
+            }
+        }
+        if (is_placed) {
+            continue;
+        }
+
+        // Hidden singles: a digit with one place in a row, box or column; placed digits keep their
+        // bit, so a unit without any is a contradiction.
+        for (size_t d = 0; d < DIGITS; ++d) {
+            const band_mask_t* p_digit = &s.digits[d * BANDS];
+            for (size_t b = 0; b < BANDS; ++b) {
+                for (size_t i = 0; i < board::GRID_SIZE; ++i) {
+                    for (const band_mask_t unit : {details::BAND_ROWS[i], details::BAND_BOXES[i]}) {
+                        const band_mask_t m = p_digit[b] & unit;
+                        if (m == 0) {
+                            return false;
+                        }
+                        if (is_single(m) && ((m & s.unsolved[b]) != 0)) {
+                            if (! assign(s, b, lowest_bit(m), d)) {
+                                return false;
+                            }
+                            is_placed = true;
+                        }
+                    }
+                }
+            }
+            for (size_t c = 0; c < board::COL_SIZE; ++c) {
+                size_t places = 0;
+                size_t band = 0;
+                for (size_t b = 0; b < BANDS; ++b) {
+                    const band_mask_t m = p_digit[b] & details::BAND_COLS[c];
+                    if (m != 0) {
+                        places += is_single(m) ? 1 : 2;
+                        band = b;
+                    }
+                }
+                if (places == 0) {
+                    return false;
+                }
+                const band_mask_t m = p_digit[band] & details::BAND_COLS[c];
+                if ((places == 1) && ((m & s.unsolved[band]) != 0)) {
+                    if (! assign(s, band, lowest_bit(m), d)) {
+                        return false;
+                    }
+                    is_placed = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool init(const board::grid_t& g, state& s)
+{
+    s.digits.fill(details::BAND_ALL_CELLS);
+    s.unsolved.fill(details::BAND_ALL_CELLS);
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        const board::value_t v = g[details::CELL_ROW[p]][details::CELL_COL[p]];
+        if ((v != 0) && (! assign(s, p / details::BAND_SIZE, p % details::BAND_SIZE, v - 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void store_solution(const state& s, board::grid_t& g)
+{
+    for (size_t d = 0; d < DIGITS; ++d) {
+        for (size_t b = 0; b < BANDS; ++b) {
+            for (band_mask_t m = s.digits[d * BANDS + b]; m != 0; m &= m - 1) {
+                const size_t p = b * details::BAND_SIZE + lowest_bit(m);
+                g[details::CELL_ROW[p]][details::CELL_COL[p]] = static_cast<board::value_t>(d + 1);
+            }
+        }
+    }
+}
+
+// Propagates s in place, children are searched on copies. Each build recurses into itself, so
+// the level is dispatched once per run and not per node.
+template<details::isa_level TLevel>
+void search(search_context& ctx, state& s);
+
+template<details::isa_level TLevel>
+ENGINE_KERNEL_INLINE void search_node(search_context& ctx, state& s)
+{
+    ENGINE_COUNT_DEPTH();
+    if (! ctx.spend_node()) {
+        return;
+    }
+
+    if (! propagate(s)) {
+        return;
+    }
+
+    // A bivalue cell when there is one, otherwise the first unsolved cell.
+    size_t band = BANDS;
+    band_mask_t cell = 0;
+    for (size_t b = 0; b < BANDS; ++b) {
+        if (s.unsolved[b] == 0) {
+            continue;
+        }
+        band_mask_t once = 0;
+        band_mask_t twice = 0;
+        band_mask_t thrice = 0;
+        for (size_t d = 0; d < DIGITS; ++d) {
+            const band_mask_t w = s.digits[d * BANDS + b];
+            thrice |= twice & w;
+            twice |= once & w;
+            once |= w;
+        }
+        const band_mask_t bivalue = s.unsolved[b] & twice & ~thrice;
+        if (bivalue != 0) {
+            band = b;
+            cell = bivalue & (0u - bivalue);
+            break;
+        }
+        if (band == BANDS) {
+            band = b;
+            cell = s.unsolved[b] & (0u - s.unsolved[b]);
+        }
+    }
+    if (band == BANDS) {
+        ++ctx.solutions_count;
+        if (ctx.solutions_count == 1) {
+            ctx.solution = s;
+        }
+        return;
+    }
+
+    const size_t bit = lowest_bit(cell);
+    for (size_t d = 0; d < DIGITS; ++d) {
+        if ((s.digits[d * BANDS + band] & cell) == 0) {
+            continue;
+        }
+        state child = s;
+        if (assign(child, band, bit, d)) {
+            search<TLevel>(ctx, child);
+        }
+        if ((ctx.solutions_count >= ctx.limit) || ctx.is_budget_exceeded()) {
+            return;
+        }
+    }
+}
+
+template<>
+void search<details::isa_level::GENERIC>(search_context& ctx, state& s)
+{
+    search_node<details::isa_level::GENERIC>(ctx, s);
+}
+
+#if defined(ENGINE_CPU_DISPATCH)
+// tzcnt and blsr for the walks over set bits.
+template<>
+ENGINE_TARGET_BMI2 void search<details::isa_level::BMI2>(search_context& ctx, state& s)
+{
+    search_node<details::isa_level::BMI2>(ctx, s);
+}
+#endif
+
+using search_fn_t = void (*)(search_context&, state&);
+
+// The band words gain nothing from AVX2 or AVX-512 over BMI2.
+#if defined(ENGINE_CPU_DISPATCH)
+constexpr details::kernel_table_t<search_fn_t> KERNELS = {
+    search<details::isa_level::GENERIC>, search<details::isa_level::BMI2>,
+    search<details::isa_level::BMI2>, search<details::isa_level::BMI2>
+};
+#else
+constexpr details::kernel_table_t<search_fn_t> KERNELS = {
+    search<details::isa_level::GENERIC>, search<details::isa_level::GENERIC>,
+    search<details::isa_level::GENERIC>, search<details::isa_level::GENERIC>
+};
+#endif
+
+} // <anonymous> namespace
+
+bitboard_solver::bitboard_solver(grid_t grid)
+    : m_grid(std::move(grid))
+{}
+
+bool bitboard_solver::can_solve(const grid_t& g)
+{
+    return local().solve(g);
+}
+
+search_result bitboard_solver::can_solve(const grid_t& g, budget& b)
+{
+    return local().solve(g, b);
+}
+
+size_t bitboard_solver::calc_solutions(const grid_t& g, const size_t limit)
+{
+    bitboard_solver& bs = local();
+    bs.reset(g);
+    return bs.count_solutions(limit);
+}
+
+size_t bitboard_solver::count_solutions(const size_t limit)
+{
+    return run(limit);
+}
+
+search_result bitboard_solver::count_solutions(const grid_t& g, budget& b, size_t& count, const size_t limit)
+{
+    reset(g);
+    m_p_budget = &b;
+    count = run(limit);
+    m_p_budget = nullptr;
+    if ((count < limit) && b.is_exceeded()) {
+        return search_result::BUDGET_EXCEEDED;
+    }
+    return search_result::SUCCESS;
+}
+
+bitboard_solver& bitboard_solver::local()
+{
+    thread_local bitboard_solver bs;
+    return bs;
+}
+
+size_t bitboard_solver::run(const size_t limit)
+{
+    search_context ctx;
+    ctx.p_budget = m_p_budget;
+    ctx.limit = limit;
+
+    state s;
+    if ((limit != 0) && board::is_valid(m_grid) && init(m_grid, s)) {
+        details::select_kernel(KERNELS)(ctx, s);
+    }
+    if (ctx.solutions_count != 0) {
+        store_solution(ctx.solution, m_grid);
+    }
+    return ctx.solutions_count;
+}
+
+bool bitboard_solver::solve()
+{
+    return (run(1) == 1);
+}
+
+bool bitboard_solver::solve(grid_t grid)
+{
+    reset(std::move(grid));
+    return solve();
+}
+
+search_result bitboard_solver::solve(budget& b)
+{
+    m_p_budget = &b;
+    const bool is_success = solve();
+    m_p_budget = nullptr;
+
+    if (is_success) {
+        return search_result::SUCCESS;
+    }
+    return (b.is_exceeded()) ? search_result::BUDGET_EXCEEDED : search_result::FAILURE;
+}
+
+search_result bitboard_solver::solve(grid_t grid, budget& b)
+{
+    reset(std::move(grid));
+    return solve(b);
+}
+
+} // namespace engine
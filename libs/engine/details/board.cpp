@@ -3,35 +3,17 @@
 #include <functional>
 
 #include "engine/board.h"
-#include "engine/details/utils.h"
+#include "engine/counters.h"
+#include "engine/details/tables.h"
 
 namespace engine {
 namespace {
 
-using ch_row_t = std::array<board::tag_t, board::COL_SIZE>;
-using ch_grid_t = std::array<ch_row_t, board::ROW_SIZE>;
 using possible_value_t = std::array<board::tag_t, board::GRID_SIZE * board::GRID_SIZE>;
-using possible_row_t = std::array<possible_value_t, board::COL_SIZE>;
-using possible_grid_t = std::array<possible_row_t, board::ROW_SIZE>;
+using possible_grid_t = std::array<possible_value_t, board::BOARD_SIZE>;
 
-using changed_fn_t = std::function<board::tag_t(size_t)>;
 using is_correct_tag_fn_t = std::function<bool(board::tag_t)>;
 
-struct changed_pos_t final
-{
-    bool is_valid() const { return (pos != board::BOARD_SIZE);}
-
-    size_t pos = board::BOARD_SIZE;
-};
-
-template<class TInputIterator, class TUnaryFn>
-inline void for_each_n(TInputIterator it, size_t n, TUnaryFn f)
-{
-    for (size_t i = 0; i < n; ++it, ++i) {
-        f(*it);
-    }
-}
-
 template<class TType, class TUnaryFn>
 inline void set_if(TType& var, const TType& val, TUnaryFn f)
 {
@@ -40,40 +22,19 @@ inline void set_if(TType& var, const TType& val, TUnaryFn f)
     }
 }
 
-changed_pos_t find_change(const changed_fn_t& ch_fn, const board::tag_t t)
-{
-    changed_pos_t ch;
-    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
-        if (ch_fn(p) == t) {
-            ch.pos = p;
-            break;
-        }
-    }
-    return ch;
-}
-
 inline bool is_valid_tag(const board::tag_t t) { return t == board::INVALID_TAG; }
 
-void mark(possible_grid_t& possible_grid, const size_t r, const size_t c,
-          board::value_t v, const board::tag_t t, const is_correct_tag_fn_t& is_valid_fn)
+inline board::hash_t zobrist_key(const size_t p, const board::value_t v) { return details::ZOBRIST_KEYS[p][v - 1]; }
+
+void mark(possible_grid_t& possible_grid, const size_t p, board::value_t v, const board::tag_t t,
+          const is_correct_tag_fn_t& is_valid_fn)
 {
     v -= 1;
 
-    // Set rows.
-    for (possible_row_t& row : possible_grid) {
-        set_if(row[c][v], t, is_valid_fn);
-    }
-    // Set columns.
-    for (possible_value_t& cell : possible_grid[r]) {
-        set_if(cell[v], t, is_valid_fn);
-    }
-    // Set grid.
-    const size_t start_col = details::grid_start_col(c);
-    const size_t start_row = details::grid_start_row(r);
-    for (size_t row = start_row; row < start_row + board::GRID_SIZE; ++row) {
-        for (size_t col = start_col; col < start_col + board::GRID_SIZE; ++col) {
-            set_if(possible_grid[row][col][v], t, is_valid_fn);
-        }
+    // The cell itself and its row, column and grid peers.
+    set_if(possible_grid[p][v], t, is_valid_fn);
+    for (const details::cell_idx_t peer : details::PEERS[p]) {
+        set_if(possible_grid[peer][v], t, is_valid_fn);
     }
 }
 
@@ -96,46 +57,33 @@ board::board(grid_t g)
 
 void board::init()
 {
-    for (size_t p = 0; p < BOARD_SIZE; ++p) {
-        const size_t c = to_col(p);
-        const size_t r = to_row(p);
-
-        m_possible[r][c].fill(INVALID_TAG);
-        m_ch_grid[r][c] = INVALID_TAG;
+    for (poss_value_t& cell : m_possible) {
+        cell.fill(INVALID_TAG);
     }
+    m_ch_grid.fill(INVALID_TAG);
+    m_max_tag = DEFAULT_TAG;
+    m_hash = 0;
 
-    for (size_t r = 0; r < ROW_SIZE; ++r) {
-        for (size_t c = 0; c < COL_SIZE; ++c) {
-            if (m_grid[r][c] != 0) {
-                m_ch_grid[r][c] = DEFAULT_TAG;
-                mark(m_possible, r, c, m_grid[r][c], DEFAULT_TAG, is_valid_tag);
-            }
+    // Values outside 1-9 would index the tables out of bounds; they stay unmarked in the grid for
+    // validate() to report.
+    for (size_t p = 0; p < BOARD_SIZE; ++p) {
+        const value_t v = m_grid[to_row(p)][to_col(p)];
+        if ((v >= BEGIN_VALUE) && (v < END_VALUE)) {
+            m_hash ^= zobrist_key(p, v);
+            m_ch_grid[p] = DEFAULT_TAG;
+            mark(m_possible, p, v, DEFAULT_TAG, is_valid_tag);
         }
     }
 }
 
 bool board::is_available(const size_t p, const value_t v) const
 {
-    return (m_ch_grid[to_row(p)][to_col(p)] == INVALID_TAG) &&
-           (m_possible[to_row(p)][to_col(p)][v - 1] == INVALID_TAG);
+    return (m_ch_grid[p] == INVALID_TAG) && (m_possible[p][v - 1] == INVALID_TAG);
 }
 
 bool board::is_possible(const size_t p, const value_t v) const
 {
-    return (m_ch_grid[to_row(p)][to_col(p)] != 0) &&
-           (m_possible[to_row(p)][to_col(p)][v - 1] == INVALID_TAG);
-}
-
-board::tag_t board::max_tag() const
-{
-    tag_t max_tag = DEFAULT_TAG;
-    for (size_t r = 0; r < ROW_SIZE; ++r) {
-        for (size_t c = 0; c < COL_SIZE; ++c) {
-            max_tag = std::max(m_ch_grid[r][c], max_tag);
-        }
-    }
-
-    return max_tag;
+    return (m_ch_grid[p] != 0) && (m_possible[p][v - 1] == INVALID_TAG);
 }
 
 void board::reset(grid_t g)
@@ -150,74 +98,115 @@ void board::rollback(const tag_t t)
         return;
     }
 
-    for (poss_row_t& pos_row : m_possible) {
-        for (poss_value_t& pos_cell : pos_row) {
-            for (value_t v = BEGIN_VALUE; v < END_VALUE; ++v) {
-                set_if(pos_cell[v - 1], INVALID_TAG, [t](tag_t tag) -> bool { return (tag == t); });
-            }
+    for (poss_value_t& pos_cell : m_possible) {
+        for (tag_t& tag : pos_cell) {
+            ENGINE_COUNT_IF(undone, tag == t);
+            set_if(tag, INVALID_TAG, [t](tag_t cur) -> bool { return (cur == t); });
         }
     }
 
-    const changed_fn_t ch_fn = [&](size_t p) -> tag_t { return m_ch_grid[to_row(p)][to_col(p)]; };
-    changed_pos_t f_ch = find_change(ch_fn, t);
-    while (f_ch.is_valid()) {
-        m_ch_grid[to_row(f_ch.pos)][to_col(f_ch.pos)] = INVALID_TAG;
-        m_grid[to_row(f_ch.pos)][to_col(f_ch.pos)] = 0;
-
-        f_ch = find_change(ch_fn, t);
+    for (size_t p = 0; p < BOARD_SIZE; ++p) {
+        if (m_ch_grid[p] == t) {
+            ENGINE_COUNT(undone);
+            value_t& cell = m_grid[to_row(p)][to_col(p)];
+            m_hash ^= zobrist_key(p, cell);
+            m_ch_grid[p] = INVALID_TAG;
+            cell = 0;
+        }
     }
 }
 
 void board::rollback_to_tag(const tag_t t)
 {
+    ENGINE_COUNT(rollbacks);
     tag_t tag = max_tag();
     while (tag > t) {
         rollback(tag);
         --tag;
     }
+    m_max_tag = std::min(m_max_tag, std::max(t, DEFAULT_TAG));
 }
 
 bool board::set_impossible(const size_t p, value_t v, const tag_t t)
 {
+    ENGINE_COUNT(set_impossibles);
     if (! is_possible(p, v)) {
         return false;
     }
 
-    m_possible[to_row(p)][to_col(p)][v - 1] = t;
+    m_possible[p][v - 1] = t;
+    m_max_tag = std::max(m_max_tag, t);
     return true;
 }
 
 bool board::set_value(const size_t p, const value_t v, const tag_t t)
 {
-    const size_t c = to_col(p);
-    const size_t r = to_row(p);
+    ENGINE_COUNT(set_values);
+    value_t& cell = m_grid[to_row(p)][to_col(p)];
 
-    if (m_ch_grid[r][c] == 0) {
+    if (m_ch_grid[p] == 0) {
         return false;
-    } else if (m_ch_grid[r][c] != INVALID_TAG) {
-        const tag_t old_tag = m_ch_grid[r][c];
-        mark(m_possible, r, c, m_grid[r][c], INVALID_TAG,
-             [&old_tag](tag_t t) -> bool { return (t == old_tag); });
+    } else if (m_ch_grid[p] != INVALID_TAG) {
+        const tag_t old_tag = m_ch_grid[p];
+        mark(m_possible, p, cell, INVALID_TAG, [&old_tag](tag_t t) -> bool { return (t == old_tag); });
 
-        m_grid[r][c] = 0;
-        m_ch_grid[r][c] = INVALID_TAG;
+        m_hash ^= zobrist_key(p, cell);
+        cell = 0;
+        m_ch_grid[p] = INVALID_TAG;
     }
 
-    m_grid[r][c] = v;
-    m_ch_grid[r][c] = t;
-    mark(m_possible, r, c, v, t, is_valid_tag);
+    cell = v;
+    m_ch_grid[p] = t;
+    m_max_tag = std::max(m_max_tag, t);
+    m_hash ^= zobrist_key(p, v);
+    mark(m_possible, p, v, t, is_valid_tag);
     return true;
 }
 
+board::conflicts_t board::validate(const grid_t& g)
+{
+    using unit_masks_t = std::array<uint16_t, ROW_SIZE>;
+
+    // Bit v of a dup mask is set once digit v is seen twice in the unit.
+    unit_masks_t row_seen = {}, col_seen = {}, box_seen = {};
+    unit_masks_t row_dup = {}, col_dup = {}, box_dup = {};
+    for (size_t p = 0; p < BOARD_SIZE; ++p) {
+        const value_t v = g[to_row(p)][to_col(p)];
+        const uint16_t bit = ((v > 0) && (v < END_VALUE)) ? static_cast<uint16_t>(1u << v) : 0;
+        const size_t r = details::CELL_ROW[p];
+        const size_t c = details::CELL_COL[p];
+        const size_t b = details::CELL_BOX[p];
+
+        row_dup[r] |= row_seen[r] & bit;
+        col_dup[c] |= col_seen[c] & bit;
+        box_dup[b] |= box_seen[b] & bit;
+        row_seen[r] |= bit;
+        col_seen[c] |= bit;
+        box_seen[b] |= bit;
+    }
+
+    conflicts_t res;
+    for (size_t p = 0; p < BOARD_SIZE; ++p) {
+        const value_t v = g[to_row(p)][to_col(p)];
+        if ((v < 0) || (v >= END_VALUE)) {
+            res.set(p);
+        } else if (v != 0) {
+            const uint16_t dup = row_dup[details::CELL_ROW[p]] | col_dup[details::CELL_COL[p]]
+                               | box_dup[details::CELL_BOX[p]];
+            res.set(p, ((dup >> v) & 1) != 0);
+        }
+    }
+    return res;
+}
+
 size_t board::to_col(const size_t p)
 {
-    return details::col_by_position(p);
+    return details::CELL_COL[p];
 }
 
 size_t board::to_row(const size_t p)
 {
-    return details::row_by_position(p);
+    return details::CELL_ROW[p];
 }
 
 } // namespace engine
-
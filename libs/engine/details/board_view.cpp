@@ -1,36 +1,45 @@
 #include "engine/board_view.h"
-#include "engine/details/utils.h"
 
 namespace engine {
+namespace {
 
-board_view::board_view(grid_t& g)
-    : m_p_grid(&g)
-{}
-
-bool board_view::is_set_value(const size_t p) const
+template<typename TStorage>
+board::grid_t copy_grid(const TStorage& s)
 {
-    return ((*m_p_grid)[to_row(p)][to_col(p)] != 0);
+    board::grid_t g;
+    for (size_t r = 0; r < board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < board::COL_SIZE; ++c) {
+            g[r][c] = s.get(r * board::COL_SIZE + c);
+        }
+    }
+    return g;
 }
 
-void board_view::set_value(const size_t p, const value_t v)
-{
-    (*m_p_grid)[to_row(p)][to_col(p)] = v;
-}
+} // <anonymous> namespace
 
-size_t board_view::to_col(const size_t p)
+template<typename TByte>
+board::grid_t basic_nibble_storage<TByte>::grid() const
 {
-    return details::col_by_position(p);
+    return copy_grid(*this);
 }
 
-size_t board_view::to_row(const size_t p)
+template<typename TValue>
+board::grid_t basic_strided_storage<TValue>::grid() const
 {
-    return details::row_by_position(p);
+    return copy_grid(*this);
 }
 
-board_view::value_t board_view::value(const size_t p) const
+template<typename TChar>
+board::grid_t basic_text_storage<TChar>::grid() const
 {
-    return (*m_p_grid)[to_row(p)][to_col(p)];
+    return copy_grid(*this);
 }
 
-} // namespace engine
+template class basic_nibble_storage<uint8_t>;
+template class basic_nibble_storage<const uint8_t>;
+template class basic_strided_storage<board::value_t>;
+template class basic_strided_storage<const board::value_t>;
+template class basic_text_storage<char>;
+template class basic_text_storage<const char>;
 
+} // namespace engine
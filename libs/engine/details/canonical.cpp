@@ -0,0 +1,189 @@
+#include <utility>
+
+#include "engine/canonical.h"
+
+namespace engine {
+namespace {
+
+using grid_t = board::grid_t;
+
+grid_t transposed(const grid_t& g)
+{
+    grid_t res;
+    for (size_t r = 0; r < board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < board::COL_SIZE; ++c) {
+            res[c][r] = g[r][c];
+        }
+    }
+    return res;
+}
+
+// Equals board(g).hash() without building the board.
+board::hash_t hash_of(const grid_t& g)
+{
+    board::hash_t h = 0;
+    for (size_t r = 0; r < board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < board::COL_SIZE; ++c) {
+            if (g[r][c] != 0) {
+                h ^= details::ZOBRIST_KEYS[r * board::COL_SIZE + c][g[r][c] - 1];
+            }
+        }
+    }
+    return h;
+}
+
+// Row k opens a band not used yet or continues the band of row k - 1.
+bool is_allowed_row(const transform::lines_t& rows, const size_t k, const size_t r)
+{
+    const size_t band = r / board::GRID_SIZE;
+    if (k % board::GRID_SIZE == 0) {
+        for (size_t i = 0; i < k; i += board::GRID_SIZE) {
+            if (rows[i] / board::GRID_SIZE == band) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (rows[k - 1] / board::GRID_SIZE != band) {
+        return false;
+    }
+    for (size_t i = k - k % board::GRID_SIZE; i < k; ++i) {
+        if (rows[i] == r) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // <anonymous> namespace
+
+transform::grid_t transform::apply(const grid_t& g) const
+{
+    grid_t res;
+    for (size_t i = 0; i < board::ROW_SIZE; ++i) {
+        for (size_t j = 0; j < board::COL_SIZE; ++j) {
+            const value_t v = is_transposed ? g[cols[j]][rows[i]] : g[rows[i]][cols[j]];
+            res[i][j] = digits[v];
+        }
+    }
+    return res;
+}
+
+transform::grid_t transform::revert(const grid_t& g) const
+{
+    digits_t inverse = {};
+    for (size_t v = 0; v < digits.size(); ++v) {
+        inverse[digits[v]] = static_cast<value_t>(v);
+    }
+
+    grid_t res;
+    for (size_t i = 0; i < board::ROW_SIZE; ++i) {
+        for (size_t j = 0; j < board::COL_SIZE; ++j) {
+            value_t& v = is_transposed ? res[cols[j]][rows[i]] : res[rows[i]][cols[j]];
+            v = inverse[g[i][j]];
+        }
+    }
+    return res;
+}
+
+canonicalizer::canonicalizer(std::pmr::memory_resource* p_mr)
+    : m_candidates(p_mr)
+    , m_next(p_mr)
+{}
+
+canonical_form canonicalizer::calc(const grid_t& g)
+{
+    thread_local canonicalizer cn;
+    return cn.canonicalize(g);
+}
+
+canonical_form canonicalizer::canonicalize(const grid_t& g)
+{
+    const std::array<grid_t, 2> views = {g, transposed(g)};
+
+    board::row_t best = {};
+    bool has_best = false;
+    m_next.clear();
+    for (size_t t = 0; t < views.size(); ++t) {
+        for (size_t r = 0; r < board::ROW_SIZE; ++r) {
+            for (size_t p = 0; p < details::LINE_PERMUTATIONS_COUNT; ++p) {
+                candidate c;
+                c.rows[0] = static_cast<uint8_t>(r);
+                c.cols = static_cast<uint16_t>(p);
+                c.is_transposed = (t != 0);
+                extend(views[t][r], c, best, has_best);
+            }
+        }
+    }
+
+    for (size_t k = 1; k < board::ROW_SIZE; ++k) {
+        std::swap(m_candidates, m_next);
+        m_next.clear();
+        has_best = false;
+        for (const candidate& c : m_candidates) {
+            const grid_t& view = views[c.is_transposed ? 1 : 0];
+            for (size_t r = 0; r < board::ROW_SIZE; ++r) {
+                if (is_allowed_row(c.rows, k, r)) {
+                    candidate next = c;
+                    next.rows[k] = static_cast<uint8_t>(r);
+                    extend(view[r], next, best, has_best);
+                }
+            }
+        }
+    }
+
+    // Any survivor gives the same grid, they differ by automorphisms only.
+    const candidate& c = m_next.front();
+    const details::line_perm_t& cols = details::LINE_PERMUTATIONS[c.cols];
+
+    canonical_form f;
+    f.trans.is_transposed = c.is_transposed;
+    f.trans.rows = c.rows;
+    for (size_t j = 0; j < board::COL_SIZE; ++j) {
+        f.trans.cols[j] = cols[j];
+    }
+    // Digits missing from g take the labels left, so solutions of the canonical grid map back too.
+    board::value_t label = c.next_label;
+    for (size_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
+        f.trans.digits[v] = (c.labels[v] != 0) ? c.labels[v] : label++;
+    }
+    f.grid = f.trans.apply(g);
+    f.hash = hash_of(f.grid);
+    return f;
+}
+
+void canonicalizer::extend(const board::row_t& src, candidate c, board::row_t& best, bool& has_best)
+{
+    const details::line_perm_t& cols = details::LINE_PERMUTATIONS[c.cols];
+
+    board::row_t row;
+    bool is_less = ! has_best;
+    for (size_t j = 0; j < board::COL_SIZE; ++j) {
+        board::value_t v = src[cols[j]];
+        if (v != 0) {
+            if (c.labels[v] == 0) {
+                c.labels[v] = c.next_label++;
+            }
+            v = c.labels[v];
+        }
+        if (! is_less) {
+            if (v > best[j]) {
+                return;
+            }
+            is_less = (v < best[j]);
+        }
+        row[j] = v;
+    }
+
+    if (is_less) {
+        best = row;
+        has_best = true;
+        m_next.clear();
+    }
+    if (m_next.size() < MAX_CANDIDATES) {
+        m_next.push_back(c);
+    }
+}
+
+} // namespace engine
@@ -1,19 +1,73 @@
 #include <cassert>
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "engine/counters.h"
 #include "engine/solver.h"
 #include "engine/details/checker.h"
+#include "engine/details/task_pool.h"
 #include "engine/details/utils.h"
 
 namespace engine {
 namespace details {
 
-checker::checker()
+namespace {
+
+struct count_item final
 {
+    board b;
+    board::tag_t tag = board::BEGIN_TAG;
+    size_t depth = 0;
+};
+
+} // <anonymous> namespace
+
+struct checker::parallel_context final
+{
+    parallel_context(const size_t workers, const size_t lim)
+        : pool(workers)
+        , checkers(workers)
+        , budgets(workers)
+        , limit(lim)
+    {
+        for (size_t i = 0; i < workers; ++i) {
+            budgets[i].set_cancel_flag(&is_stop);
+            checkers[i].m_p_budget = &budgets[i];
+        }
+    }
+
+    void add_solutions(const size_t n)
+    {
+        if (n == 0) {
+            return;
+        }
+        if (count.fetch_add(n, std::memory_order_relaxed) + n >= limit) {
+            is_stop.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    task_pool<count_item> pool;
+    std::vector<checker> checkers;
+    std::vector<budget> budgets;
+
+    std::atomic<size_t> count{0};
+    std::atomic<bool> is_stop{false};
+    const size_t limit;
+};
+
+checker::checker(std::pmr::memory_resource* p_mr)
+    : m_log(make_log(p_mr))
+    , m_tt(transposition_table::DEFAULT_SIZE, p_mr)
+    , m_nogoods(0, p_mr)
+{
+    // find_guess_cell() shuffles the indices before every use.
     for (size_t i = 0; i < m_rand_board_idx.size(); ++i) {
         m_rand_board_idx[i] = i;
     }
-    shaffle_array(m_rand_board_idx);
 }
 
 checker::log_item& checker::add_item(const board::tag_t t)
@@ -62,59 +116,59 @@ void checker::add_very_hard_item(const board::tag_t t)
 
 void checker::calc(const board::grid_t& g, const size_t limit)
 {
-    reset_solutions();
-
-    board b(g);
-    calculate_solutions(b, limit);
-    calculate_difficulty(b);
+    reset(g);
+    calc_loaded(limit);
 }
 
-void checker::calc(const board_view& b, const size_t limit)
+void checker::calc(const board& b, const size_t limit)
 {
     reset_solutions();
 
-    board brd(b.grid());
-    calculate_solutions(brd, limit);
-    calculate_difficulty(brd);
+    m_board = b;
+    calculate_solutions(m_board, limit);
+    m_board = b;
+    calculate_difficulty(m_board);
 }
 
-void checker::calc(const board& b, const size_t limit)
+void checker::calc_loaded(const size_t limit)
 {
     reset_solutions();
 
-    calculate_solutions(b, limit);
-    calculate_difficulty(b);
+    // Counting rolls the board back to the givens, so the rating starts from the same state.
+    calculate_solutions(m_board, limit);
+    calculate_difficulty(m_board);
 }
 
 checker::difficult checker::calc_difficulty(const board::grid_t& g)
 {
-    checker ch;
-    return ch.calculate_difficulty(board(g));
+    checker& ch = local();
+    ch.reset(g);
+    return ch.calculate_difficulty(ch.m_board);
 }
 
-checker::difficult checker::calc_difficulty(const board_view& b)
+checker::difficult checker::calc_difficulty(const board& b)
 {
-    checker ch;
-    return ch.calculate_difficulty(board(b.grid()));
+    checker& ch = local();
+    ch.m_board = b;
+    return ch.calculate_difficulty(ch.m_board);
 }
 
-checker::difficult checker::calc_difficulty(const board& b)
+search_result checker::calc_difficulty(const board::grid_t& g, budget& bgt, difficult& d)
 {
-    checker ch;
-    return ch.calculate_difficulty(b);
+    return local().rate_difficulty(g, bgt, d);
 }
 
-checker::difficult checker::calculate_difficulty(board b)
+checker::difficult checker::calculate_difficulty(board& b)
 {
     reset();
     m_dif = difficult::INVALID;
-    const bool is_solved = solve(b, board::BEGIN_TAG);
+    const bool is_solved = search(b);
     if (is_solved) {
         if (m_log.empty()) {
             m_dif = difficult::INVALID;
         } else {
             const log_item& item = m_log.top();
-            if (item.is_very_hard) {
+            if (item.is_very_hard || m_has_learned) {
                 m_dif = difficult::VERY_HARD;
             } else if (item.is_hard) {
                 m_dif = difficult::HARD;
@@ -134,41 +188,70 @@ checker::difficult checker::calculate_difficulty(board b)
 
 size_t checker::calc_solutions(const board::grid_t& g, const size_t limit)
 {
-    checker ch;
-    return ch.calculate_solutions(board(g), limit);
+    checker& ch = local();
+    ch.reset(g);
+    return ch.calculate_solutions(ch.m_board, limit);
 }
 
-size_t checker::calc_solutions(const board_view& b, const size_t limit)
+size_t checker::calc_solutions(const board& b, const size_t limit)
 {
-    checker ch;
-    return ch.calculate_solutions(board(b.grid()), limit);
+    checker& ch = local();
+    ch.m_board = b;
+    return ch.calculate_solutions(ch.m_board, limit);
 }
 
-size_t checker::calc_solutions(board b, const size_t limit)
+search_result checker::calc_solutions(const board::grid_t& g, budget& bgt, size_t& count, const size_t limit)
 {
-    checker ch;
-    return ch.calculate_solutions(b, limit);
+    return local().count_solutions(g, bgt, count, limit);
+}
+
+size_t checker::calc_solutions_parallel(const board::grid_t& g, const size_t limit, const size_t threads)
+{
+    if (! board::is_valid(g)) {
+        return 0;
+    }
+
+    const size_t workers = (threads != 0) ? threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    parallel_context ctx(workers, limit);
+    ctx.pool.push(0, count_item{board(g), board::BEGIN_TAG, 0});
+    ctx.pool.run([&ctx](const size_t worker, count_item& item) -> void {
+        count_task(ctx, worker, item.b, item.tag, item.depth);
+    });
+    return ctx.count.load();
 }
 
-size_t checker::calculate_solutions(board b, const size_t limit)
+size_t checker::calculate_solutions(board& b, const size_t limit)
 {
     reset();
-    m_solutions_count = calculate_solutions(b, board::BEGIN_TAG, limit);
+    m_solutions_count = board::is_valid(b.grid()) ? calculate_solutions(b, board::BEGIN_TAG, limit) : 0;
     reset();
     return m_solutions_count;
 }
 
 size_t checker::calculate_solutions(board& b, const board::tag_t t, const size_t limit)
 {
+    ENGINE_COUNT_DEPTH();
+    const board::hash_t hash = b.hash();
+    size_t cached_count = 0;
+    if (m_tt.find(hash, limit, cached_count)) {
+        return cached_count;
+    }
+
+    if (! spend_node()) {
+        rollback_to_tag(b, t);
+        return 0;
+    }
+
     const board::tag_t single_tag = t + 1;
-    while (solve_single(b, single_tag)) {
+    while (propagate(b, single_tag)) {
 		if (solver::is_solved(b)) {
 			rollback_to_tag(b, t);
-			return 1;
+			return store_solutions(hash, 1, limit);
 		}
 		if (solver::is_impossible(b)) {
 			rollback_to_tag(b, t);
-			return 0;
+			return store_solutions(hash, 0, limit);
 		}
 	}
 
@@ -176,9 +259,9 @@ size_t checker::calculate_solutions(board& b, const board::tag_t t, const size_t
 	const board::tag_t guess_tag = single_tag + 1;
 
 	const details::is_set_fn_t is_set_fn =
-	    [b](size_t p) -> bool { return b.is_set_value(p); };
+	    [&b](size_t p) -> bool { return b.is_set_value(p); };
     const details::is_poss_fn_t is_poss_fn =
-        [b](size_t p, board::value_t v) -> bool { return b.is_possible(p, v); };
+        [&b](size_t p, board::value_t v) -> bool { return b.is_possible(p, v); };
 
     details::guess_t guess = details::find_guess_cell(is_set_fn, is_poss_fn, m_rand_board_idx);
     for (size_t i = 0; i < guess.available.size(); ++i) {
@@ -192,14 +275,73 @@ size_t checker::calculate_solutions(board& b, const board::tag_t t, const size_t
 
         set_guess_value(b, guess.pos, value, guess_tag);
         solutions_count += calculate_solutions(b, guess_tag, limit);
-        if (solutions_count >= limit) {
+        if ((solutions_count >= limit) || is_budget_exceeded()) {
             rollback_to_tag(b, t);
-            return solutions_count;
+            return store_solutions(hash, solutions_count, limit);
         }
     }
 
     rollback_to_tag(b, t);
-    return solutions_count;
+    return store_solutions(hash, solutions_count, limit);
+}
+
+search_result checker::count_solutions(const board::grid_t& g, budget& bgt, size_t& count, const size_t limit)
+{
+    reset(g);
+    m_p_budget = &bgt;
+    count = calculate_solutions(m_board, limit);
+    m_p_budget = nullptr;
+    if ((count < limit) && bgt.is_exceeded()) {
+        return search_result::BUDGET_EXCEEDED;
+    }
+    return search_result::SUCCESS;
+}
+
+void checker::count_task(parallel_context& ctx, const size_t worker, board& b, const board::tag_t t,
+                         const size_t depth)
+{
+    if (ctx.is_stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    checker& ch = ctx.checkers[worker];
+    ch.reset();
+    if (depth >= PARALLEL_SPLIT_DEPTH) {
+        ctx.add_solutions(ch.calculate_solutions(b, t, ctx.limit));
+        return;
+    }
+
+    // Every task owns its board, so the subtree is split without rollbacks.
+    const board::tag_t single_tag = t + 1;
+    while (ch.propagate(b, single_tag)) {}
+    if (solver::is_solved(b)) {
+        ctx.add_solutions(1);
+        return;
+    }
+    if (solver::is_impossible(b)) {
+        return;
+    }
+
+    const details::is_set_fn_t is_set_fn =
+        [&b](size_t p) -> bool { return b.is_set_value(p); };
+    const details::is_poss_fn_t is_poss_fn =
+        [&b](size_t p, board::value_t v) -> bool { return b.is_possible(p, v); };
+
+    const details::guess_t guess = details::find_guess_cell(is_set_fn, is_poss_fn, ch.m_rand_board_idx);
+    if (! guess.is_valid()) {
+        return;
+    }
+
+    const board::tag_t guess_tag = single_tag + 1;
+    for (size_t i = 0; i < guess.available.size(); ++i) {
+        if (! guess.available[i]) {
+            continue;
+        }
+
+        count_item child{b, guess_tag, depth + 1};
+        child.b.set_value(guess.pos, i + 1, guess_tag);
+        ctx.pool.push(worker, std::move(child));
+    }
 }
 
 std::string checker::difficult_to_str(const difficult d)
@@ -207,12 +349,29 @@ std::string checker::difficult_to_str(const difficult d)
     return generator::difficult_to_str(d);
 }
 
+void checker::learn_conflict()
+{
+    m_nogoods.learn(m_learn_root, m_guesses.data(), m_guesses_count);
+}
+
+checker& checker::local()
+{
+    thread_local checker ch;
+    return ch;
+}
+
+checker::log_t checker::make_log(std::pmr::memory_resource* p_mr)
+{
+    std::pmr::vector<log_item> items(p_mr);
+    items.reserve(LOG_RESERVE);
+    return log_t(std::move(items));
+}
+
 void checker::reset()
 {
     while (! m_log.empty()) {
         m_log.pop();
     }
-    shaffle_array(m_rand_board_idx);
 }
 
 void checker::reset_solutions()
@@ -230,6 +389,57 @@ void checker::rollback_to_tag(board& b, const board::tag_t t)
     }
 }
 
+search_result checker::rate_difficulty(const board::grid_t& g, budget& bgt, difficult& d)
+{
+    reset(g);
+    m_p_budget = &bgt;
+    d = calculate_difficulty(m_board);
+    m_p_budget = nullptr;
+    if ((d == difficult::INVALID) && bgt.is_exceeded()) {
+        return search_result::BUDGET_EXCEEDED;
+    }
+    return (d != difficult::INVALID) ? search_result::SUCCESS : search_result::FAILURE;
+}
+
+bool checker::search(board& b)
+{
+    if (! board::is_valid(b.grid())) {
+        return false;
+    }
+
+    m_has_learned = false;
+    m_guesses_count = 0;
+    if (m_nogoods.is_enabled()) {
+        m_nogoods.clear();
+        m_learn_root = b;
+        while (subsets_pipeline::apply(m_learn_root, board::BEGIN_TAG)) {}
+    }
+
+    if (! m_restart.is_enabled()) {
+        return solve(b, board::BEGIN_TAG);
+    }
+
+    const board init_board = b;
+    m_restart.reset();
+    while (true) {
+        m_backtracks = 0;
+        m_is_restarting = false;
+        if (solve(b, board::BEGIN_TAG)) {
+            return true;
+        }
+        if ((! m_is_restarting) || is_budget_exceeded()) {
+            return false;
+        }
+
+        rollback_to_tag(b, board::BEGIN_TAG);
+        if (! m_restart.is_keep_learned()) {
+            b = init_board;
+            m_has_learned = false;
+        }
+        m_restart.next();
+    }
+}
+
 void checker::set_guess_value(board& b, const size_t p, const board::value_t v, const board::tag_t t)
 {
     if (b.set_value(p, v, t)) {
@@ -237,24 +447,59 @@ void checker::set_guess_value(board& b, const size_t p, const board::value_t v,
     }
 }
 
+size_t checker::store_solutions(const board::hash_t h, const size_t count, const size_t limit)
+{
+    // A search cut by the budget proves nothing about the subtree.
+    if (! is_budget_exceeded()) {
+        m_tt.store(h, count, count < limit);
+    }
+    return count;
+}
+
 bool checker::solve(board& b, const board::tag_t t)
 {
+    ENGINE_COUNT_DEPTH();
+    if (! spend_node()) {
+        rollback_to_tag(b, t);
+        return false;
+    }
+
     const board::tag_t single_tag = t + 1;
-    while (solve_single(b, single_tag)) {
-		if (solver::is_solved(b)) {
-			return true;
-		}
-		if (solver::is_impossible(b)) {
-			return false;
-		}
-	}
+    bool is_reduced = true;
+    while (is_reduced) {
+        while (solve_single(b, single_tag)) {
+            if (solver::is_solved(b)) {
+                return true;
+            }
+            if (solver::is_impossible(b)) {
+                learn_conflict();
+                return false;
+            }
+        }
+
+        is_reduced = false;
+        if (m_nogoods.is_enabled()) {
+            const nogood_store::status res = m_nogoods.apply(b, single_tag);
+            if (res == nogood_store::status::CONFLICT) {
+                return false;
+            } else if (res == nogood_store::status::REDUCED) {
+                // Eliminations learned by guessing keep the rating at VERY_HARD.
+                m_has_learned = true;
+                if (solver::is_impossible(b)) {
+                    learn_conflict();
+                    return false;
+                }
+                is_reduced = true;
+            }
+        }
+    }
 
 	const board::tag_t guess_tag = single_tag + 1;
 
 	const details::is_set_fn_t is_set_fn =
-	    [b](size_t p) -> bool { return b.is_set_value(p); };
+	    [&b](size_t p) -> bool { return b.is_set_value(p); };
     const details::is_poss_fn_t is_poss_fn =
-        [b](size_t p, board::value_t v) -> bool { return b.is_possible(p, v); };
+        [&b](size_t p, board::value_t v) -> bool { return b.is_possible(p, v); };
 
     details::guess_t guess = details::find_guess_cell(is_set_fn, is_poss_fn, m_rand_board_idx);
     if (! guess.is_valid()) {
@@ -272,9 +517,32 @@ bool checker::solve(board& b, const board::tag_t t)
         const board::value_t value = i + 1;
         assert(value > 0 && value < 10);
 
+        m_guesses[m_guesses_count++] = {static_cast<cell_idx_t>(guess.pos), value};
         set_guess_value(b, guess.pos, value, guess_tag);
-        if (solver::is_impossible(b) || ! solve(b, guess_tag)) {
+        bool is_failed = solver::is_impossible(b);
+        if (is_failed) {
+            learn_conflict();
+        } else {
+            is_failed = ! solve(b, guess_tag);
+        }
+        --m_guesses_count;
+
+        if (is_failed) {
             rollback_to_tag(b, t);
+            if (is_budget_exceeded() || m_is_restarting) {
+                return false;
+            }
+            if (m_restart.is_enabled()) {
+                if ((t == board::BEGIN_TAG) && m_restart.is_keep_learned()) {
+                    // Eliminations learned by guessing keep the rating at VERY_HARD.
+                    m_has_learned |= b.set_impossible(guess.pos, value, board::DEFAULT_TAG);
+                }
+                ++m_backtracks;
+                if (m_backtracks >= m_restart.limit()) {
+                    m_is_restarting = true;
+                    return false;
+                }
+            }
         } else {
             return true;
         }
@@ -285,53 +553,16 @@ bool checker::solve(board& b, const board::tag_t t)
 
 bool checker::solve_single(board& b, const board::tag_t t)
 {
-    if (solve_single_easy(b, t))        { return true; }
-    if (solve_single_medium(b, t))      { return true; }
-    if (solve_single_hard(b, t))        { return true; }
-    return false;
-}
-
-bool checker::solve_single_easy(board& b, const board::tag_t t)
-{
-    if (details::solve_single_cell(b, t)) {
-        add_easy_item(t);
-        return true;
-    }
-    return false;
-}
-
-bool checker::solve_single_hard(board& b, const board::tag_t t)
-{
-    if (details::mark_naked_pairs(b, t)) {
-        add_hard_item(t);
-        return true;
-    }
-    if (details::mark_hidden_pairs_col(b, t)) {
-        add_hard_item(t);
-        return true;
-    }
-    if (details::mark_hidden_pairs_row(b, t)) {
-        add_hard_item(t);
-        return true;
-    }
-    return false;
-}
-
-bool checker::solve_single_medium(board& b, const board::tag_t t)
-{
-    if (details::solve_single_value_col(b, t)) {
-        add_medium_item(t);
-        return true;
-    }
-    if (details::solve_single_value_row(b, t)) {
-        add_medium_item(t);
-        return true;
-    }
-    if (details::solve_single_value_section(b, t)) {
-        add_medium_item(t);
-        return true;
-    }
-    return false;
+    const auto logger = [this](const technique_level l, const board::tag_t tag) -> void {
+        if (l == technique_level::EASY) {
+            add_easy_item(tag);
+        } else if (l == technique_level::MEDIUM) {
+            add_medium_item(tag);
+        } else {
+            add_hard_item(tag);
+        }
+    };
+    return subsets_pipeline::apply(b, t, logger);
 }
 
 } // namespace details
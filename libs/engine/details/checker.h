@@ -1,9 +1,16 @@
 #include <array>
+#include <memory_resource>
 #include <stack>
+#include <vector>
 
 #include "engine/board.h"
 #include "engine/board_view.h"
+#include "engine/budget.h"
 #include "engine/generator.h"
+#include "engine/restart_policy.h"
+#include "engine/details/nogood_store.h"
+#include "engine/details/techniques.h"
+#include "engine/details/transposition_table.h"
 
 namespace engine {
 namespace details {
@@ -16,23 +23,79 @@ private:
 public:
     using difficult = generator::difficult;
 
-    checker();
+    // Guess levels split into pool tasks by calc_solutions_parallel(); deeper levels run sequentially.
+    static constexpr size_t PARALLEL_SPLIT_DEPTH = 6;
+
+    explicit checker(std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    // Reusable context: loads g into the owned board, keeping the index order and log storage.
+    void reset(const board::grid_t& g) { m_board.reset(g); }
+    template<typename TStorage>
+    void reset(const basic_board_view<TStorage>& b) { m_board.reset_from(b.storage()); }
 
     void calc(const board::grid_t& g, const size_t limit = 2);
-    void calc(const board_view& b, const size_t limit = 2);
+    // Text lines, packed records and strided buffers are checked through their views, unconverted.
+    template<typename TStorage>
+    void calc(const basic_board_view<TStorage>& b, const size_t limit = 2)
+    {
+        reset(b);
+        calc_loaded(limit);
+    }
     void calc(const board& b, const size_t limit = 2);
 
     difficult difficulty() const { return m_dif; }
 
+    bool is_templates_enabled() const { return m_is_templates_enabled; }
+
+    size_t nogood_capacity() const { return m_nogoods.capacity(); }
+
+    const restart_policy& restart_mode() const { return m_restart; }
+
+    void set_restart_policy(const restart_policy& p) { m_restart = p; }
+
+    // Nogoods learned from failed guesses while rating, zero (the default) disables learning.
+    void set_nogood_capacity(const size_t capacity) { m_nogoods.set_capacity(capacity); }
+
+    // Template overlay after the other techniques when counting: stronger propagation, fewer guesses,
+    // but a table scan per step. The rating is not affected.
+    void set_templates_enabled(const bool is_enabled) { m_is_templates_enabled = is_enabled; }
+
+    // Entries of the solution count cache, zero disables it.
+    void set_transposition_size(const size_t entries) { m_tt.resize(entries); }
+
     size_t solutions_count() const { return m_solutions_count; }
 
+    size_t transposition_size() const { return m_tt.size(); }
+
+    // Budgeted counting and rating on this context; the static helpers run them on local().
+    search_result count_solutions(const board::grid_t& g, budget& bgt, size_t& count, const size_t limit = 2);
+    search_result rate_difficulty(const board::grid_t& g, budget& bgt, difficult& d);
+
     static difficult calc_difficulty(const board::grid_t& g);
-    static difficult calc_difficulty(const board_view& b);
+    template<typename TStorage>
+    static difficult calc_difficulty(const basic_board_view<TStorage>& b)
+    {
+        checker& ch = local();
+        ch.reset(b);
+        return ch.calculate_difficulty(ch.m_board);
+    }
     static difficult calc_difficulty(const board& b);
+    static search_result calc_difficulty(const board::grid_t& g, budget& bgt, difficult& d);
 
     static size_t calc_solutions(const board::grid_t& g, const size_t limit = 2);
-    static size_t calc_solutions(const board_view& b, const size_t limit = 2);
-    static size_t calc_solutions(board b, const size_t limit = 2);
+    template<typename TStorage>
+    static size_t calc_solutions(const basic_board_view<TStorage>& b, const size_t limit = 2)
+    {
+        checker& ch = local();
+        ch.reset(b);
+        return ch.calculate_solutions(ch.m_board, limit);
+    }
+    static size_t calc_solutions(const board& b, const size_t limit = 2);
+    static search_result calc_solutions(const board::grid_t& g, budget& bgt, size_t& count,
+                                        const size_t limit = 2);
+
+    static size_t calc_solutions_parallel(const board::grid_t& g, const size_t limit = 2,
+                                          const size_t threads = 0);
 
     static std::string difficult_to_str(const difficult d);
 
@@ -47,6 +110,14 @@ private:
         bool is_very_hard = false;
     };
 
+    // The log keeps its capacity between calls, and a log item per tag of the deepest search is
+    // reserved up front, so a context does not allocate while searching.
+    using log_t = std::stack<log_item, std::pmr::vector<log_item>>;
+
+    static constexpr size_t LOG_RESERVE = 2 * board::BOARD_SIZE + 2;
+
+    struct parallel_context;
+
 private:
     log_item& add_item(const board::tag_t t);
     void add_easy_item(const board::tag_t t);
@@ -54,34 +125,72 @@ private:
     void add_medium_item(const board::tag_t t);
     void add_very_hard_item(const board::tag_t t);
 
-    difficult calculate_difficulty(board b);
+    difficult calculate_difficulty(board& b);
 
-    size_t calculate_solutions(board b, const size_t limit);
+    size_t calculate_solutions(board& b, const size_t limit);
 
     size_t calculate_solutions(board& b, const board::tag_t t, const size_t limit);
 
+    static void count_task(parallel_context& ctx, const size_t worker, board& b, const board::tag_t t,
+                           const size_t depth);
+
     size_t random_pos(size_t p) const { return m_rand_board_idx[p]; }
 
+    void learn_conflict();
+
+    // Per-thread context behind the static helpers.
+    static checker& local();
+
+    static log_t make_log(std::pmr::memory_resource* p_mr);
+
     void reset();
     void reset_solutions();
 
+    // Counts and rates the grid loaded into m_board.
+    void calc_loaded(const size_t limit);
+
     void rollback_to_tag(board& b, const board::tag_t t);
 
+    bool search(board& b);
+
+    bool spend_node() { return (m_p_budget == nullptr) || m_p_budget->spend(); }
+
     void set_guess_value(board& b, const size_t p, const board::value_t v, const board::tag_t t);
 
+    bool is_budget_exceeded() const { return (m_p_budget != nullptr) && m_p_budget->is_exceeded(); }
+
     bool solve(board& b, const board::tag_t t);
 
+    size_t store_solutions(const board::hash_t h, const size_t count, const size_t limit);
+
+    // Rating path: every technique hit is logged for the difficulty.
     bool solve_single(board& b, const board::tag_t t);
 
-    bool solve_single_easy(board& b, const board::tag_t t);
-    bool solve_single_hard(board& b, const board::tag_t t);
-    bool solve_single_medium(board& b, const board::tag_t t);
+    // Counting path: the same techniques without logging.
+    bool propagate(board& b, const board::tag_t t) const
+    {
+        return m_is_templates_enabled ? templates_pipeline::apply(b, t) : subsets_pipeline::apply(b, t);
+    }
 
 private:
+    board m_board;
     random_indices_t m_rand_board_idx;
-    std::stack<log_item> m_log;
+    log_t m_log;
+    transposition_table m_tt;
     difficult m_dif = difficult::INVALID;
     size_t m_solutions_count = 0;
+    budget* m_p_budget = nullptr;
+
+    restart_policy m_restart;
+    size_t m_backtracks = 0;
+    bool m_is_restarting = false;
+    bool m_has_learned = false;
+    bool m_is_templates_enabled = false;
+
+    nogood_store m_nogoods;
+    board m_learn_root;
+    std::array<nogood_store::literal, board::BOARD_SIZE> m_guesses;
+    size_t m_guesses_count = 0;
 };
 
 } // namespace details
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <bitset>
+
+#include "engine/codec.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+namespace {
+
+constexpr uint32_t ALL_DIGITS = (1u << board::ROW_SIZE) - 1;
+constexpr uint32_t ROW_CODE_MASK = (1u << codec::ROW_CODE_BITS) - 1;
+constexpr uint8_t NIBBLE_MASK = 0x0f;
+
+constexpr std::array<uint32_t, board::ROW_SIZE + 1> make_factorials()
+{
+    std::array<uint32_t, board::ROW_SIZE + 1> t = {};
+    t[0] = 1;
+    for (size_t i = 1; i < t.size(); ++i) {
+        t[i] = t[i - 1] * static_cast<uint32_t>(i);
+    }
+    return t;
+}
+
+constexpr std::array<uint32_t, board::ROW_SIZE + 1> FACTORIALS = make_factorials();
+
+inline uint32_t bit_count(const uint32_t x) { return static_cast<uint32_t>(std::bitset<32>(x).count()); }
+
+// Index of the lowest set bit of a non-zero x.
+inline uint32_t lowest_bit(const uint32_t x) { return bit_count((x & (0u - x)) - 1); }
+
+inline board::value_t& cell(board::grid_t& g, const size_t p) { return g[details::CELL_ROW[p]][details::CELL_COL[p]]; }
+
+inline board::value_t cell(const board::grid_t& g, const size_t p) { return g[details::CELL_ROW[p]][details::CELL_COL[p]]; }
+
+} // <anonymous> namespace
+
+size_t codec::encode_puzzle(const grid_t& g, puzzle_t& rec)
+{
+    rec.fill(0);
+    uint8_t* p_digits = rec.data() + BITMAP_SIZE;
+
+    // Empty cells OR zero into the current nibble and do not advance, so the loop has no branches.
+    size_t count = 0;
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        const uint8_t v = static_cast<uint8_t>(cell(g, p));
+        const uint8_t is_given = (v != 0);
+        rec[p / 8] |= static_cast<uint8_t>(is_given << (p % 8));
+        p_digits[count / 2] |= static_cast<uint8_t>(v << (4 * (count % 2)));
+        count += is_given;
+    }
+    return BITMAP_SIZE + (count + 1) / 2;
+}
+
+size_t codec::decode_puzzle(const uint8_t* p_rec, const size_t size, grid_t& g)
+{
+    if (size < BITMAP_SIZE) {
+        return 0;
+    }
+    const size_t rec_size = puzzle_size(p_rec);
+    if (size < rec_size) {
+        return 0;
+    }
+
+    // Reads past the last given are clamped to the record, their digit is masked out anyway.
+    const uint8_t no_digits = 0;
+    const bool has_digits = (rec_size > BITMAP_SIZE);
+    const uint8_t* p_digits = has_digits ? p_rec + BITMAP_SIZE : &no_digits;
+    const size_t last = has_digits ? rec_size - BITMAP_SIZE - 1 : 0;
+
+    // Bits past cell 80 must be clear.
+    uint8_t is_bad = p_rec[BITMAP_SIZE - 1] >> (board::BOARD_SIZE % 8);
+    size_t count = 0;
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        const uint8_t is_given = (p_rec[p / 8] >> (p % 8)) & 1;
+        const uint8_t byte = p_digits[std::min(count / 2, last)];
+        const uint8_t d = (byte >> (4 * (count % 2))) & NIBBLE_MASK;
+        is_bad |= is_given & static_cast<uint8_t>(static_cast<uint8_t>(d - 1) >= board::ROW_SIZE);
+        cell(g, p) = static_cast<board::value_t>(d & static_cast<uint8_t>(0 - is_given));
+        count += is_given;
+    }
+    return (is_bad == 0) ? rec_size : 0;
+}
+
+size_t codec::puzzle_size(const uint8_t* p_bitmap)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < BITMAP_SIZE; ++i) {
+        count += bit_count(p_bitmap[i]);
+    }
+    // Padding bits of the last byte are not cells.
+    count -= bit_count(p_bitmap[BITMAP_SIZE - 1] >> (board::BOARD_SIZE % 8));
+    return BITMAP_SIZE + (count + 1) / 2;
+}
+
+codec::solution_t codec::encode_solution(const grid_t& g)
+{
+    solution_t rec = {};
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    size_t pos = 0;
+    for (size_t r = 0; r + 1 < board::ROW_SIZE; ++r) {
+        // Lehmer code: each digit counts the smaller digits still unused in the row.
+        uint32_t code = 0;
+        uint32_t used = 0;
+        for (size_t c = 0; c < board::COL_SIZE; ++c) {
+            const uint32_t d = static_cast<uint32_t>(g[r][c] - 1);
+            code += bit_count(~used & ((1u << d) - 1)) * FACTORIALS[board::COL_SIZE - 1 - c];
+            used |= 1u << d;
+        }
+
+        acc |= static_cast<uint64_t>(code) << acc_bits;
+        acc_bits += ROW_CODE_BITS;
+        for (; acc_bits >= 8; acc_bits -= 8, acc >>= 8) {
+            rec[pos++] = static_cast<uint8_t>(acc);
+        }
+    }
+    if (acc_bits != 0) {
+        rec[pos] = static_cast<uint8_t>(acc);
+    }
+    return rec;
+}
+
+bool codec::decode_solution(const solution_t& rec, grid_t& g)
+{
+    // Decoded into a copy, g is left untouched by a malformed record.
+    grid_t res;
+    uint64_t acc = 0;
+    size_t acc_bits = 0;
+    size_t pos = 0;
+    std::array<uint32_t, board::COL_SIZE> col_used = {};
+    for (size_t r = 0; r + 1 < board::ROW_SIZE; ++r) {
+        for (; acc_bits < ROW_CODE_BITS; acc_bits += 8) {
+            acc |= static_cast<uint64_t>(rec[pos++]) << acc_bits;
+        }
+        uint32_t code = static_cast<uint32_t>(acc) & ROW_CODE_MASK;
+        acc >>= ROW_CODE_BITS;
+        acc_bits -= ROW_CODE_BITS;
+        if (code >= FACTORIALS[board::COL_SIZE]) {
+            return false;
+        }
+
+        uint32_t used = 0;
+        for (size_t c = 0; c < board::COL_SIZE; ++c) {
+            const uint32_t f = FACTORIALS[board::COL_SIZE - 1 - c];
+            const uint32_t k = code / f;
+            code %= f;
+
+            // The k-th unused digit, found without branching on the digits.
+            uint32_t d = 0;
+            uint32_t seen = 0;
+            for (uint32_t i = 0; i < board::ROW_SIZE; ++i) {
+                const uint32_t is_free = ((used >> i) & 1) ^ 1;
+                d |= i & (0u - (is_free & static_cast<uint32_t>(seen == k)));
+                seen += is_free;
+            }
+            used |= 1u << d;
+            col_used[c] |= 1u << d;
+            res[r][c] = static_cast<board::value_t>(d + 1);
+        }
+    }
+
+    uint32_t row_used = 0;
+    for (size_t c = 0; c < board::COL_SIZE; ++c) {
+        const uint32_t missing = ~col_used[c] & ALL_DIGITS;
+        if (bit_count(missing) != 1) {
+            return false;
+        }
+        const uint32_t d = lowest_bit(missing);
+        row_used |= 1u << d;
+        res[board::ROW_SIZE - 1][c] = static_cast<board::value_t>(d + 1);
+    }
+    // Rows and columns are permutations by construction, the boxes are not.
+    if ((row_used != ALL_DIGITS) || (! board::is_valid(res))) {
+        return false;
+    }
+
+    g = res;
+    return true;
+}
+
+} // namespace engine
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <sstream>
+
+#include "engine/counters.h"
+
+namespace engine {
+namespace {
+
+size_t& depth()
+{
+    thread_local size_t d = 0;
+    return d;
+}
+
+} // <anonymous> namespace
+
+counters& counters::operator+=(const counters& other)
+{
+    set_values += other.set_values;
+    set_impossibles += other.set_impossibles;
+    rollbacks += other.rollbacks;
+    undone += other.undone;
+    guesses += other.guesses;
+    max_depth = std::max(max_depth, other.max_depth);
+    for (size_t i = 0; i < technique_hits.size(); ++i) {
+        technique_hits[i] += other.technique_hits[i];
+    }
+    return *this;
+}
+
+counters& counters::local()
+{
+    thread_local counters c;
+    return c;
+}
+
+void counters::reset()
+{
+    local() = counters();
+}
+
+std::string counters::technique_to_str(const technique_id id)
+{
+    if (id == technique_id::SINGLE_CELL) {
+        return "SINGLE_CELL";
+    } else if (id == technique_id::SINGLE_VALUE_COL) {
+        return "SINGLE_VALUE_COL";
+    } else if (id == technique_id::SINGLE_VALUE_ROW) {
+        return "SINGLE_VALUE_ROW";
+    } else if (id == technique_id::SINGLE_VALUE_SECTION) {
+        return "SINGLE_VALUE_SECTION";
+    } else if (id == technique_id::NAKED_PAIRS) {
+        return "NAKED_PAIRS";
+    } else if (id == technique_id::HIDDEN_PAIRS_COL) {
+        return "HIDDEN_PAIRS_COL";
+    } else if (id == technique_id::HIDDEN_PAIRS_ROW) {
+        return "HIDDEN_PAIRS_ROW";
+    }
+    return "TEMPLATES";
+}
+
+std::string counters::to_json() const
+{
+    std::stringstream ss;
+    ss << "{\"set_values\":" << set_values
+       << ",\"set_impossibles\":" << set_impossibles
+       << ",\"rollbacks\":" << rollbacks
+       << ",\"undone\":" << undone
+       << ",\"guesses\":" << guesses
+       << ",\"max_depth\":" << max_depth
+       << ",\"technique_hits\":{";
+    for (size_t i = 0; i < technique_hits.size(); ++i) {
+        ss << ((i != 0) ? "," : "") << "\"" << technique_to_str(static_cast<technique_id>(i)) << "\":"
+           << technique_hits[i];
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+counters::depth_guard::depth_guard()
+{
+    counters& c = local();
+    c.max_depth = std::max(c.max_depth, ++depth());
+}
+
+counters::depth_guard::~depth_guard()
+{
+    --depth();
+}
+
+} // namespace engine
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <atomic>
+
+#include "engine/details/cpu_dispatch.h"
+
+namespace engine {
+namespace details {
+namespace {
+
+cpu_features detect()
+{
+    cpu_features f;
+#if defined(ENGINE_CPU_DISPATCH)
+    __builtin_cpu_init();
+    f.has_popcnt = __builtin_cpu_supports("popcnt");
+    f.has_bmi = __builtin_cpu_supports("bmi");
+    f.has_bmi2 = __builtin_cpu_supports("bmi2");
+    f.has_avx2 = __builtin_cpu_supports("avx2");
+    f.has_avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                && __builtin_cpu_supports("avx512vl");
+#endif
+    return f;
+}
+
+std::atomic<isa_level>& active_level()
+{
+    static std::atomic<isa_level> level(cpu_features::get().level());
+    return level;
+}
+
+} // <anonymous> namespace
+
+isa_level active_isa_level()
+{
+    return active_level().load(std::memory_order_relaxed);
+}
+
+isa_level cpu_features::level() const
+{
+    if (! (has_popcnt && has_bmi && has_bmi2)) {
+        return isa_level::GENERIC;
+    }
+    if (! has_avx2) {
+        return isa_level::BMI2;
+    }
+    return has_avx512 ? isa_level::AVX512 : isa_level::AVX2;
+}
+
+const cpu_features& cpu_features::get()
+{
+    static const cpu_features features = detect();
+    return features;
+}
+
+void force_isa_level(const isa_level l)
+{
+    active_level().store(std::min(l, cpu_features::get().level()), std::memory_order_relaxed);
+}
+
+void reset_isa_level()
+{
+    active_level().store(cpu_features::get().level(), std::memory_order_relaxed);
+}
+
+std::string isa_level_to_str(const isa_level l)
+{
+    if (l == isa_level::GENERIC) {
+        return "GENERIC";
+    } else if (l == isa_level::BMI2) {
+        return "BMI2";
+    } else if (l == isa_level::AVX2) {
+        return "AVX2";
+    }
+    return "AVX512";
+}
+
+} // namespace details
+} // namespace engine
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <string>
+
+// Hot kernels are built once per instruction set level with ENGINE_TARGET_* from one
+// ENGINE_KERNEL_INLINE body. Every module keeps its builds in a kernel_table_t indexed by
+// isa_level and picks the entry of active_isa_level() once per call, outside its inner loops.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define ENGINE_CPU_DISPATCH
+    #define ENGINE_KERNEL_INLINE [[gnu::always_inline]] inline
+    #define ENGINE_TARGET_BMI2 [[gnu::target("popcnt,bmi,bmi2")]]
+    #define ENGINE_TARGET_AVX2 [[gnu::target("popcnt,bmi,bmi2,avx2")]]
+    #define ENGINE_TARGET_AVX512 [[gnu::target("popcnt,bmi,bmi2,avx2,avx512f,avx512bw,avx512vl")]]
+#else
+    #define ENGINE_KERNEL_INLINE inline
+#endif
+
+namespace engine {
+namespace details {
+
+// Every level includes the features of the ones before it.
+enum class isa_level
+{
+    GENERIC,
+    BMI2,
+    AVX2,
+    AVX512
+};
+
+constexpr size_t ISA_LEVELS_COUNT = 4;
+
+template<typename TKernel>
+using kernel_table_t = std::array<TKernel, ISA_LEVELS_COUNT>;
+
+struct cpu_features final
+{
+    bool has_popcnt = false;
+    bool has_bmi = false;
+    bool has_bmi2 = false;
+    bool has_avx2 = false;
+    // AVX-512 F, BW and VL.
+    bool has_avx512 = false;
+
+    isa_level level() const;
+
+    // cpuid is queried once, on the first call.
+    static const cpu_features& get();
+};
+
+// The level of the running CPU, or the lower one forced by force_isa_level().
+isa_level active_isa_level();
+
+// Runs the kernels of level l, clamped to the CPU's, so that every build can be checked against
+// the generic one; reset_isa_level() returns to the CPU's level.
+void force_isa_level(const isa_level l);
+void reset_isa_level();
+
+template<typename TKernel>
+const TKernel& select_kernel(const kernel_table_t<TKernel>& table)
+{
+    return table[static_cast<size_t>(active_isa_level())];
+}
+
+std::string isa_level_to_str(const isa_level l);
+
+} // namespace details
+} // namespace engine
@@ -1,5 +1,7 @@
 #include <cassert>
-#include <cstdlib>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 #include "engine/board_view.h"
 #include "engine/generator.h"
@@ -22,8 +24,7 @@ enum rotate
 
 rotate randomizer()
 {
-    details::init_random();
-    return static_cast<rotate>(std::rand() % rotate::size);
+    return static_cast<rotate>(details::random_engine()() % rotate::size);
 }
 
 size_t rotate_position(size_t pos, const rotate r)
@@ -51,13 +52,135 @@ size_t rotate_position(size_t pos, const rotate r)
     return pos;
 }
 
+using clock_t = std::chrono::steady_clock;
+
+// Threads add their calls to their own slot, readers walk the slots; slots of finished threads are
+// folded into m_retired.
+class stats_registry final
+{
+public:
+    struct slot final
+    {
+        slot() { stats_registry::instance().add(this); }
+        ~slot() { stats_registry::instance().remove(this); }
+
+        void add(const generator::stats& st)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats += st;
+        }
+
+        std::mutex mutex;
+        generator::stats stats;
+    };
+
+public:
+    static stats_registry& instance()
+    {
+        static stats_registry registry;
+        return registry;
+    }
+
+    static slot& local()
+    {
+        thread_local slot s;
+        return s;
+    }
+
+    void add(slot* p_slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots.push_back(p_slot);
+    }
+
+    void remove(slot* p_slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots.erase(std::find(m_slots.begin(), m_slots.end(), p_slot));
+        m_retired += p_slot->stats;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_retired = generator::stats();
+        for (slot* p_slot : m_slots) {
+            std::lock_guard<std::mutex> slot_lock(p_slot->mutex);
+            p_slot->stats = generator::stats();
+        }
+    }
+
+    generator::stats total()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generator::stats st = m_retired;
+        for (slot* p_slot : m_slots) {
+            std::lock_guard<std::mutex> slot_lock(p_slot->mutex);
+            st += p_slot->stats;
+        }
+        return st;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<slot*> m_slots;
+    generator::stats m_retired;
+};
+
 } // <anonymous> namespace
 
-generator::generator()
+double generator::stats::attempts(const difficult d) const
+{
+    const size_t count = difficulties[static_cast<size_t>(d)];
+    return (count != 0) ? static_cast<double>(calls) / count : 0.0;
+}
+
+generator::stats& generator::stats::operator+=(const stats& other)
+{
+    calls += other.calls;
+    grid_time += other.grid_time;
+    solutions_calls += other.solutions_calls;
+    solutions_time += other.solutions_time;
+    removals_accepted += other.removals_accepted;
+    removals_rejected += other.removals_rejected;
+    rating_time += other.rating_time;
+    for (size_t i = 0; i < difficulties.size(); ++i) {
+        difficulties[i] += other.difficulties[i];
+    }
+    return *this;
+}
+
+generator::generator(std::pmr::memory_resource* p_mr)
+    : m_p_checker(nullptr, checker_deleter{p_mr})
 {
+    std::pmr::polymorphic_allocator<details::checker> alloc(p_mr);
+    details::checker* p_checker = alloc.allocate(1);
+    try {
+        new (p_checker) details::checker(p_mr);
+    } catch (...) {
+        alloc.deallocate(p_checker, 1);
+        throw;
+    }
+    m_p_checker.reset(p_checker);
+
+    // The checker only rates the final grid, the table would not be reused.
+    m_p_checker->set_transposition_size(0);
     init();
 }
 
+generator::generator(generator&& other) noexcept = default;
+
+generator::~generator() = default;
+
+generator& generator::operator=(generator&& other) noexcept = default;
+
+void generator::checker_deleter::operator()(details::checker* p_checker) const
+{
+    std::pmr::polymorphic_allocator<details::checker> alloc(p_resource);
+    p_checker->~checker();
+    alloc.deallocate(p_checker, 1);
+}
+
 std::string generator::difficult_to_str(const difficult d)
 {
     if (d == difficult::EASY) {
@@ -73,11 +196,41 @@ std::string generator::difficult_to_str(const difficult d)
 }
 
 board::grid_t generator::generate()
+{
+    budget unlimited;
+    board::grid_t grid;
+    [[maybe_unused]] const search_result res = generate(grid, unlimited);
+    assert(res == search_result::SUCCESS);
+    return grid;
+}
+
+search_result generator::generate(board::grid_t& g, budget& b)
+{
+    m_stats = stats();
+    m_stats.calls = 1;
+    const search_result res = generate_puzzle(g, b);
+    if ((res == search_result::SUCCESS) && (m_dif != difficult::INVALID)) {
+        ++m_stats.difficulties[static_cast<size_t>(m_dif)];
+    }
+    stats_registry::local().add(m_stats);
+    return res;
+}
+
+search_result generator::generate_puzzle(board::grid_t& g, budget& b)
 {
     m_dif = difficult::INVALID;
     m_solutions_count = 0;
 
-    board::grid_t grid = generate_grid();
+    clock_t::time_point start = clock_t::now();
+    solver sl;
+    const search_result grid_res = sl.solve(b);
+    m_stats.grid_time += clock_t::now() - start;
+    if (grid_res != search_result::SUCCESS) {
+        return grid_res;
+    }
+    assert(solver::is_solved(sl.get_board()));
+
+    board::grid_t grid = sl.get_grid();
     board_view brd(grid);
     details::shaffle_array(m_rand_board_idx);
 
@@ -92,16 +245,32 @@ board::grid_t generator::generate()
         }
         const board::value_t orig_val = brd.value(pos);
         brd.set_value(pos, 0);
-        const size_t sol_count = details::checker::calc_solutions(brd, 2);
+        size_t sol_count = 0;
+        start = clock_t::now();
+        const search_result count_res = m_counter.count_solutions(brd.grid(), b, sol_count, 2);
+        m_stats.solutions_time += clock_t::now() - start;
+        ++m_stats.solutions_calls;
+        if (count_res == search_result::BUDGET_EXCEEDED) {
+            return search_result::BUDGET_EXCEEDED;
+        }
         if (sol_count != 1) {
             brd.set_value(pos, orig_val);
+            ++m_stats.removals_rejected;
         } else {
             m_solutions_count = sol_count;
+            ++m_stats.removals_accepted;
         }
     }
-    m_dif = details::checker::calc_difficulty(brd);
 
-    return brd.grid();
+    start = clock_t::now();
+    const search_result rate_res = m_p_checker->rate_difficulty(brd.grid(), b, m_dif);
+    m_stats.rating_time += clock_t::now() - start;
+    if (rate_res == search_result::BUDGET_EXCEEDED) {
+        return search_result::BUDGET_EXCEEDED;
+    }
+
+    g = brd.grid();
+    return search_result::SUCCESS;
 }
 
 board::grid_t generator::generate_grid()
@@ -115,6 +284,16 @@ board::grid_t generator::generate_grid()
     return brd.grid();
 }
 
+void generator::reset_total_stats()
+{
+    stats_registry::instance().reset();
+}
+
+generator::stats generator::total_stats()
+{
+    return stats_registry::instance().total();
+}
+
 void generator::init()
 {
     for (size_t i = 0; i < m_rand_board_idx.size(); ++i) {
@@ -0,0 +1,150 @@
+#include <cassert>
+#include <algorithm>
+
+#include "engine/details/nogood_store.h"
+#include "engine/details/utils.h"
+
+namespace engine {
+namespace details {
+
+nogood_store::nogood_store(const size_t capacity, std::pmr::memory_resource* p_mr)
+    : m_nogoods(p_mr)
+{
+    set_capacity(capacity);
+}
+
+void nogood_store::add(const literal* literals, const size_t count)
+{
+    assert(count <= MAX_LITERALS);
+
+    nogood* p_victim = nullptr;
+    if (m_nogoods.size() < m_capacity) {
+        p_victim = &m_nogoods.emplace_back();
+    } else {
+        p_victim = &*std::min_element(m_nogoods.begin(), m_nogoods.end(),
+                                      [](const nogood& l, const nogood& r) -> bool {
+                                          return (l.activity < r.activity);
+                                      });
+        // Halving lets recent hits outweigh old ones.
+        for (nogood& ng : m_nogoods) {
+            ng.activity /= 2;
+        }
+    }
+
+    std::copy(literals, literals + count, p_victim->literals.begin());
+    p_victim->size = count;
+    p_victim->activity = 0;
+}
+
+nogood_store::status nogood_store::apply(board& b, const board::tag_t t)
+{
+    status res = status::NONE;
+    for (nogood& ng : m_nogoods) {
+        size_t open_count = 0;
+        literal open;
+        bool is_inactive = false;
+        for (size_t i = 0; (i < ng.size) && (! is_inactive) && (open_count < 2); ++i) {
+            const literal& l = ng.literals[i];
+            if (b.is_set_value(l.pos)) {
+                is_inactive = (b.value(l.pos) != l.value);
+            } else if (b.is_possible(l.pos, l.value)) {
+                open = l;
+                ++open_count;
+            } else {
+                is_inactive = true;
+            }
+        }
+        if (is_inactive || (open_count > 1)) {
+            continue;
+        }
+
+        ++ng.activity;
+        if (open_count == 0) {
+            return status::CONFLICT;
+        }
+        b.set_impossible(open.pos, open.value, t);
+        res = status::REDUCED;
+    }
+    return res;
+}
+
+bool nogood_store::is_conflict(const board& prefix, const literal* literals, const size_t count)
+{
+    board b = prefix;
+    for (size_t i = 0; i < count; ++i) {
+        const literal& l = literals[i];
+        if (b.is_set_value(l.pos)) {
+            if (b.value(l.pos) != l.value) {
+                return true;
+            }
+        } else if (! b.is_possible(l.pos, l.value)) {
+            return true;
+        } else {
+            b.set_value(l.pos, l.value, board::BEGIN_TAG);
+        }
+    }
+
+    while (solve_single_cell(b, board::BEGIN_TAG)) {}
+    return is_impossible(b);
+}
+
+bool nogood_store::is_impossible(const board& b)
+{
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        if (b.is_set_value(p)) {
+            continue;
+        }
+
+        bool has_value = false;
+        for (board::value_t v = board::BEGIN_VALUE; (v < board::END_VALUE) && (! has_value); ++v) {
+            has_value = b.is_possible(p, v);
+        }
+        if (! has_value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool nogood_store::learn(const board& root, const literal* guesses, const size_t count)
+{
+    if ((! is_enabled()) || (count == 0) || (count > MAX_MINIMIZE_GUESSES)) {
+        return false;
+    }
+    if (count <= MAX_LITERALS) {
+        add(guesses, count);
+        return true;
+    }
+
+    // Guesses are tried in order against a prefix of the kept ones, which is propagated once.
+    std::array<literal, MAX_LITERALS> kept;
+    size_t kept_count = 0;
+    board prefix = root;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        if (is_conflict(prefix, guesses + i + 1, count - i - 1)) {
+            continue;
+        }
+        if (kept_count + 1 >= MAX_LITERALS) {
+            return false;
+        }
+
+        kept[kept_count++] = guesses[i];
+        prefix.set_value(guesses[i].pos, guesses[i].value, board::BEGIN_TAG);
+        while (solve_single_cell(prefix, board::BEGIN_TAG)) {}
+    }
+    kept[kept_count++] = guesses[count - 1];
+
+    add(kept.data(), kept_count);
+    return true;
+}
+
+void nogood_store::set_capacity(const size_t capacity)
+{
+    m_capacity = capacity;
+    m_nogoods.clear();
+    m_nogoods.shrink_to_fit();
+    m_nogoods.reserve(capacity);
+}
+
+} // namespace details
+} // namespace engine
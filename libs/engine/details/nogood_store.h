@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+namespace details {
+
+// Bounded store of nogoods: sets of guesses that together lead to a contradiction. Nogoods stay
+// valid for the whole search of a grid, restarts included, since they do not depend on the order.
+class nogood_store final
+{
+public:
+    struct literal final
+    {
+        cell_idx_t pos = 0;
+        board::value_t value = 0;
+    };
+
+    enum class status
+    {
+        NONE,
+        REDUCED,
+        CONFLICT
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    // Longer conflict sets rarely match again, so they are not kept.
+    static constexpr size_t MAX_LITERALS = 8;
+
+    // Minimizing costs a propagation per guess, so deeper conflicts are not stored.
+    static constexpr size_t MAX_MINIMIZE_GUESSES = 4 * MAX_LITERALS;
+
+public:
+    explicit nogood_store(const size_t capacity = 0,
+                          std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    // A nogood with all literals placed is a conflict, one with a single open literal forbids it at t.
+    status apply(board& b, const board::tag_t t);
+
+    size_t capacity() const { return m_capacity; }
+
+    void clear() { m_nogoods.clear(); }
+
+    bool is_enabled() const { return (m_capacity != 0); }
+
+    // Stores the guesses that ended in a contradiction. Sets longer than MAX_LITERALS are first
+    // minimized: every guess but the last is dropped if the others still conflict from root
+    // under naked singles, and sets that stay too long are not stored.
+    bool learn(const board& root, const literal* guesses, const size_t count);
+
+    // The least active nogood is evicted once the store is full.
+    void set_capacity(const size_t capacity);
+
+    size_t size() const { return m_nogoods.size(); }
+
+private:
+    struct nogood final
+    {
+        std::array<literal, MAX_LITERALS> literals;
+        size_t size = 0;
+        size_t activity = 0;
+    };
+
+private:
+    void add(const literal* literals, const size_t count);
+
+    // Whether prefix with literals placed propagates to a contradiction.
+    static bool is_conflict(const board& prefix, const literal* literals, const size_t count);
+
+    static bool is_impossible(const board& b);
+
+private:
+    std::pmr::vector<nogood> m_nogoods;
+    size_t m_capacity = 0;
+};
+
+} // namespace details
+} // namespace engine
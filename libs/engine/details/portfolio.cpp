@@ -0,0 +1,118 @@
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+#include "engine/portfolio.h"
+#include "engine/details/utils.h"
+
+namespace engine {
+namespace {
+
+struct member_result final
+{
+    search_result result = search_result::BUDGET_EXCEEDED;
+    board::grid_t grid;
+};
+
+} // <anonymous> namespace
+
+portfolio::portfolio(std::pmr::memory_resource* p_mr)
+    : m_configs(default_configs(std::max<size_t>(std::thread::hardware_concurrency(), 1)))
+    , m_p_resource(p_mr)
+{}
+
+portfolio::portfolio(configs_t configs, std::pmr::memory_resource* p_mr)
+    : m_configs(std::move(configs))
+    , m_p_resource(p_mr)
+{
+    assert(! m_configs.empty());
+}
+
+portfolio::configs_t portfolio::default_configs(const size_t count)
+{
+    using schedule = restart_policy::schedule;
+
+    const config ladder[] = {
+        {solver::probing::NONE,          restart_policy(),                          0},
+        {solver::probing::GUESS_CELL,    restart_policy(schedule::LUBY),            0},
+        {solver::probing::NONE,          restart_policy(schedule::GEOMETRIC),       0},
+        {solver::probing::BIVALUE_CELLS, restart_policy(),                          0},
+        {solver::probing::GUESS_CELL,    restart_policy(schedule::GEOMETRIC, 16),   0},
+        {solver::probing::NONE,          restart_policy(schedule::LUBY, 16, false), 0}
+    };
+    const size_t ladder_size = sizeof(ladder) / sizeof(ladder[0]);
+
+    const unsigned base_seed = static_cast<unsigned>(std::time(nullptr));
+    configs_t configs;
+    for (size_t i = 0; i < count; ++i) {
+        config cfg = ladder[i % ladder_size];
+        cfg.seed = base_seed + static_cast<unsigned>(i);
+        configs.emplace_back(cfg);
+    }
+    return configs;
+}
+
+bool portfolio::solve(const grid_t& g)
+{
+    return (solve(g, budget()) == search_result::SUCCESS);
+}
+
+search_result portfolio::solve(const grid_t& g, const budget& b)
+{
+    std::atomic<bool> is_cancel(false);
+    std::atomic<size_t> winner(INVALID_WINNER);
+    // Members write only their own slot, so the resource is used from the calling thread alone.
+    std::pmr::vector<member_result> results(m_configs.size(), m_p_resource);
+
+    const auto run_fn = [&](const size_t idx) -> void {
+        const config& cfg = m_configs[idx];
+        details::seed_random(cfg.seed);
+
+        solver sl;
+        sl.set_probing(cfg.probing);
+        sl.set_restart_policy(cfg.restart);
+
+        // The caller's cancel flag and deadline still apply through the share.
+        budget member_budget = b.share(m_configs.size());
+        member_budget.set_cancel_flag(&is_cancel);
+
+        member_result& res = results[idx];
+        res.result = sl.solve(g, member_budget);
+        if (res.result == search_result::BUDGET_EXCEEDED) {
+            return;
+        }
+
+        // Both a solution and a proof of unsolvability finish the race.
+        size_t expected = INVALID_WINNER;
+        if (winner.compare_exchange_strong(expected, idx)) {
+            res.grid = sl.get_grid();
+            is_cancel.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    // Every member runs on its own thread, so reseeding never touches the caller's random engine.
+    std::vector<std::thread> threads;
+    threads.reserve(m_configs.size());
+    for (size_t i = 0; i < m_configs.size(); ++i) {
+        threads.emplace_back(run_fn, i);
+    }
+    for (std::thread& th : threads) {
+        th.join();
+    }
+
+    m_grid = grid_t{};
+    m_winner = winner.load();
+    if (m_winner == INVALID_WINNER) {
+        return search_result::BUDGET_EXCEEDED;
+    }
+
+    const member_result& res = results[m_winner];
+    if (res.result == search_result::SUCCESS) {
+        m_grid = res.grid;
+    }
+    return res.result;
+}
+
+} // namespace engine
@@ -0,0 +1,154 @@
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "engine/solution_cache.h"
+#include "engine/solver.h"
+#include "engine/details/checker.h"
+
+namespace engine {
+
+struct solution_cache::shard final
+{
+    struct node final
+    {
+        board::hash_t hash = 0;
+        // Canonical puzzle and result, compared on lookup so hash collisions never mix puzzles.
+        grid_t puzzle;
+        result value;
+    };
+
+    using nodes_t = std::pmr::list<node>;
+
+    shard(const size_t capacity, std::pmr::memory_resource* p_mr)
+        : nodes(p_mr)
+        , index(p_mr)
+    {
+        index.reserve(capacity);
+    }
+
+    std::mutex mutex;
+    // The most recently used first.
+    nodes_t nodes;
+    std::pmr::unordered_map<board::hash_t, nodes_t::iterator> index;
+};
+
+solution_cache::solution_cache(const size_t capacity, std::pmr::memory_resource* p_mr)
+    : m_shard_capacity((capacity + SHARDS_COUNT - 1) / SHARDS_COUNT)
+{
+    for (std::unique_ptr<shard>& p_shard : m_shards) {
+        p_shard = std::make_unique<shard>(m_shard_capacity, p_mr);
+    }
+}
+
+solution_cache::~solution_cache() = default;
+
+void solution_cache::clear()
+{
+    for (std::unique_ptr<shard>& p_shard : m_shards) {
+        std::lock_guard<std::mutex> lock(p_shard->mutex);
+        p_shard->index.clear();
+        p_shard->nodes.clear();
+    }
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+}
+
+bool solution_cache::find(const grid_t& g, result& r)
+{
+    return find(canonicalizer::calc(g), r);
+}
+
+bool solution_cache::find(const canonical_form& f, result& r)
+{
+    shard& sh = shard_of(f.hash);
+    {
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        const auto it = sh.index.find(f.hash);
+        if ((it != sh.index.end()) && (it->second->puzzle == f.grid)) {
+            sh.nodes.splice(sh.nodes.begin(), sh.nodes, it->second);
+            r = it->second->value;
+            r.solution = f.trans.revert(r.solution);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+solution_cache::shard& solution_cache::shard_of(const board::hash_t h) const
+{
+    // The high bits pick the shard, the low ones the index bucket.
+    return *m_shards[h >> (64 - SHARD_BITS)];
+}
+
+size_t solution_cache::size() const
+{
+    size_t count = 0;
+    for (const std::unique_ptr<shard>& p_shard : m_shards) {
+        std::lock_guard<std::mutex> lock(p_shard->mutex);
+        count += p_shard->nodes.size();
+    }
+    return count;
+}
+
+solution_cache::result solution_cache::solve(const grid_t& g)
+{
+    const canonical_form f = canonicalizer::calc(g);
+
+    result r;
+    if (find(f, r)) {
+        return r;
+    }
+
+    r.solutions_count = details::checker::calc_solutions(g);
+    if (r.solutions_count != 0) {
+        solver sl;
+        sl.solve(g);
+        r.solution = sl.get_grid();
+        r.difficulty = details::checker::calc_difficulty(g);
+    }
+    store(f, r);
+    return r;
+}
+
+void solution_cache::store(const grid_t& g, const result& r)
+{
+    store(canonicalizer::calc(g), r);
+}
+
+void solution_cache::store(const canonical_form& f, const result& r)
+{
+    if (m_shard_capacity == 0) {
+        return;
+    }
+
+    shard& sh = shard_of(f.hash);
+    std::lock_guard<std::mutex> lock(sh.mutex);
+
+    auto it = sh.index.find(f.hash);
+    if (it == sh.index.end()) {
+        if (sh.nodes.size() < m_shard_capacity) {
+            sh.nodes.emplace_front();
+            it = sh.index.emplace(f.hash, sh.nodes.begin()).first;
+        } else {
+            // The least recently used node and its index entry are reused, so a full shard
+            // stores without allocating.
+            const shard::nodes_t::iterator last = std::prev(sh.nodes.end());
+            auto index_node = sh.index.extract(last->hash);
+            index_node.key() = f.hash;
+            it = sh.index.insert(std::move(index_node)).position;
+        }
+    }
+
+    sh.nodes.splice(sh.nodes.begin(), sh.nodes, it->second);
+    shard::node& n = sh.nodes.front();
+    n.hash = f.hash;
+    n.puzzle = f.grid;
+    n.value = r;
+    n.value.solution = f.trans.apply(r.solution);
+}
+
+} // namespace engine
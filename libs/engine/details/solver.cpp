@@ -2,35 +2,44 @@
 #include <cstddef>
 #include <algorithm>
 
+#include "engine/counters.h"
 #include "engine/solver.h"
 #include "engine/details/utils.h"
 
 namespace engine {
 
-solver::solver()
+template<typename TTechniques>
+basic_solver<TTechniques>::basic_solver()
 {
+    // find_guess_cell() shuffles the indices before every use.
     for (size_t i = 0; i < m_rand_board_idx.size(); ++i) {
         m_rand_board_idx[i] = i;
     }
-    details::shaffle_array(m_rand_board_idx);
 }
 
-solver::solver(grid_t board)
+template<typename TTechniques>
+basic_solver<TTechniques>::basic_solver(grid_t board)
     : m_solver_board(std::move(board))
 {
     for (size_t i = 0; i < m_rand_board_idx.size(); ++i) {
         m_rand_board_idx[i] = i;
     }
-    details::shaffle_array(m_rand_board_idx);
 }
 
-bool solver::can_solve(const grid_t& g)
+template<typename TTechniques>
+bool basic_solver<TTechniques>::can_solve(const grid_t& g)
 {
-    solver sl;
-    return sl.solve(g);
+    return local().solve(g);
 }
 
-bool solver::is_impossible(const board& b)
+template<typename TTechniques>
+search_result basic_solver<TTechniques>::can_solve(const grid_t& g, budget& b)
+{
+    return local().solve(g, b);
+}
+
+template<typename TTechniques>
+bool basic_solver<TTechniques>::is_impossible(const board& b)
 {
     for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
         if (! b.is_set_value(p)) {
@@ -48,7 +57,8 @@ bool solver::is_impossible(const board& b)
     return false;
 }
 
-bool solver::is_solved(const grid_t& g)
+template<typename TTechniques>
+bool basic_solver<TTechniques>::is_solved(const grid_t& g)
 {
     for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
         const size_t c = details::col_by_position(p);
@@ -62,28 +72,208 @@ bool solver::is_solved(const grid_t& g)
     return true;
 }
 
-bool solver::is_solved(const board& brd)
+template<typename TTechniques>
+bool basic_solver<TTechniques>::is_solved(const board& brd)
 {
     const grid_t& b = brd.grid();
     return is_solved(b);
 }
 
-bool solver::solve()
+template<typename TTechniques>
+void basic_solver<TTechniques>::learn_conflict()
+{
+    m_nogoods.learn(m_learn_root, m_guesses.data(), m_guesses_count);
+}
+
+template<typename TTechniques>
+basic_solver<TTechniques>& basic_solver<TTechniques>::local()
+{
+    thread_local basic_solver sl;
+    return sl;
+}
+
+template<typename TTechniques>
+typename basic_solver<TTechniques>::probe_result
+basic_solver<TTechniques>::probe(const size_t guess_pos, const board::tag_t tag)
+{
+    probe_result res = probe_cell(guess_pos, tag);
+    if ((res == probe_result::SOLVED) || (res == probe_result::FAILED)) {
+        return res;
+    }
+    if (m_probing != probing::BIVALUE_CELLS) {
+        return res;
+    }
+
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        if ((p == guess_pos) || m_solver_board.is_set_value(p)) {
+            continue;
+        }
+
+        size_t count = 0;
+        for (value_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
+            if (m_solver_board.is_possible(p, v)) {
+                ++count;
+            }
+        }
+        if (count != 2) {
+            continue;
+        }
+
+        const probe_result cell_res = probe_cell(p, tag);
+        if ((cell_res == probe_result::SOLVED) || (cell_res == probe_result::FAILED)) {
+            return cell_res;
+        }
+        if (cell_res == probe_result::REDUCED) {
+            res = probe_result::REDUCED;
+        }
+    }
+    return res;
+}
+
+template<typename TTechniques>
+typename basic_solver<TTechniques>::probe_result
+basic_solver<TTechniques>::probe_cell(const size_t p, const board::tag_t tag)
+{
+    const board::tag_t probe_tag = tag + 1;
+    const board::tag_t single_tag = tag + 2;
+
+    size_t count = 0;
+    bool is_reduced = false;
+    for (value_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
+        if (! m_solver_board.is_possible(p, v)) {
+            continue;
+        }
+        if (! spend_node()) {
+            return probe_result::FAILED;
+        }
+
+        m_solver_board.set_value(p, v, probe_tag);
+        while (solve_single(m_solver_board, single_tag)) {}
+        if (is_solved(m_solver_board)) {
+            return probe_result::SOLVED;
+        }
+
+        const bool is_failed = is_impossible(m_solver_board);
+        m_solver_board.rollback_to_tag(tag);
+        if (is_failed) {
+            m_solver_board.set_impossible(p, v, tag);
+            is_reduced = true;
+        } else {
+            ++count;
+        }
+    }
+
+    if (count == 0) {
+        return probe_result::FAILED;
+    }
+    return (is_reduced) ? probe_result::REDUCED : probe_result::NONE;
+}
+
+template<typename TTechniques>
+bool basic_solver<TTechniques>::propagate(const board::tag_t tag)
+{
+    while (true) {
+        while (solve_single(m_solver_board, tag)) {}
+        if (is_impossible(m_solver_board)) {
+            learn_conflict();
+            return false;
+        }
+        if (! m_nogoods.is_enabled()) {
+            return true;
+        }
+
+        const details::nogood_store::status res = m_nogoods.apply(m_solver_board, tag);
+        if (res == details::nogood_store::status::CONFLICT) {
+            return false;
+        } else if (res == details::nogood_store::status::NONE) {
+            return true;
+        }
+    }
+}
+
+template<typename TTechniques>
+bool basic_solver<TTechniques>::search()
+{
+    // Duplicate givens fail before any search.
+    if (! board::is_valid(m_solver_board.grid())) {
+        return false;
+    }
+
+    m_guesses_count = 0;
+    if (m_nogoods.is_enabled()) {
+        m_nogoods.clear();
+        m_learn_root = m_solver_board;
+        while (solve_single(m_learn_root, board::BEGIN_TAG)) {}
+    }
+
+    if (! m_restart.is_enabled()) {
+        return solve(board::BEGIN_TAG);
+    }
+
+    const board init_board = m_solver_board;
+    m_restart.reset();
+    while (true) {
+        m_backtracks = 0;
+        m_is_restarting = false;
+        if (solve(board::BEGIN_TAG)) {
+            return true;
+        }
+        if ((! m_is_restarting) || is_budget_exceeded()) {
+            return false;
+        }
+
+        if (m_restart.is_keep_learned()) {
+            m_solver_board.rollback_to_tag(board::BEGIN_TAG);
+        } else {
+            m_solver_board = init_board;
+        }
+        m_restart.next();
+    }
+}
+
+template<typename TTechniques>
+bool basic_solver<TTechniques>::solve()
 {
-    return solve(board::BEGIN_TAG);
+    return search();
 }
 
-bool solver::solve(grid_t grid)
+template<typename TTechniques>
+bool basic_solver<TTechniques>::solve(grid_t grid)
 {
-    m_solver_board.reset(std::move(grid));
+    reset(std::move(grid));
     return solve();
 }
 
-bool solver::solve(const board::tag_t tag)
+template<typename TTechniques>
+search_result basic_solver<TTechniques>::solve(budget& b)
 {
-    while (solve_single(m_solver_board, tag)) {}
+    m_p_budget = &b;
+    const bool is_success = search();
+    m_p_budget = nullptr;
+
+    if (is_success) {
+        return search_result::SUCCESS;
+    }
+    return (b.is_exceeded()) ? search_result::BUDGET_EXCEEDED : search_result::FAILURE;
+}
+
+template<typename TTechniques>
+search_result basic_solver<TTechniques>::solve(grid_t grid, budget& b)
+{
+    reset(std::move(grid));
+    return solve(b);
+}
+
+template<typename TTechniques>
+bool basic_solver<TTechniques>::solve(const board::tag_t tag)
+{
+    ENGINE_COUNT_DEPTH();
+    if (! spend_node()) {
+        return false;
+    }
+
+    if (! propagate(tag)) { return false; }
     if (is_solved(m_solver_board)) { return true; }
-    if (is_impossible(m_solver_board)) { return false; }
 
     const details::is_set_fn_t is_set_fn =
         [this](size_t p) -> bool { return m_solver_board.is_set_value(p); };
@@ -95,6 +285,17 @@ bool solver::solve(const board::tag_t tag)
         return false;
     }
 
+    if (m_probing != probing::NONE) {
+        const probe_result res = probe(guess.pos, tag);
+        if (res == probe_result::SOLVED) {
+            return true;
+        } else if (res == probe_result::FAILED) {
+            return false;
+        } else if (res == probe_result::REDUCED) {
+            return solve(tag);
+        }
+    }
+
     const board::tag_t guess_tag = tag + 1;
     assert(guess_tag % 2 == 0);
     const board::tag_t next_tag = tag + 2;
@@ -110,9 +311,32 @@ bool solver::solve(const board::tag_t tag)
         const value_t value = i + 1;
         assert(value > 0 && value < 10);
 
+        m_guesses[m_guesses_count++] = {static_cast<details::cell_idx_t>(guess.pos), value};
         m_solver_board.set_value(guess.pos, value, guess_tag);
-        if (is_impossible(m_solver_board) || ! solve(next_tag)) {
+        bool is_failed = is_impossible(m_solver_board);
+        if (is_failed) {
+            learn_conflict();
+        } else {
+            is_failed = ! solve(next_tag);
+        }
+        --m_guesses_count;
+
+        if (is_failed) {
             m_solver_board.rollback_to_tag(tag);
+            if (is_budget_exceeded() || m_is_restarting) {
+                return false;
+            }
+            if (m_restart.is_enabled()) {
+                if ((tag == board::BEGIN_TAG) && m_restart.is_keep_learned()) {
+                    // A refuted root guess stays refuted after restarts.
+                    m_solver_board.set_impossible(guess.pos, value, board::DEFAULT_TAG);
+                }
+                ++m_backtracks;
+                if (m_backtracks >= m_restart.limit()) {
+                    m_is_restarting = true;
+                    return false;
+                }
+            }
         } else {
             return true;
         }
@@ -120,14 +344,9 @@ bool solver::solve(const board::tag_t tag)
     return false;
 }
 
-bool solver::solve_single(board& b, const board::tag_t t)
-{
-    if (details::solve_single_cell(b, t))          { return true; }
-    if (details::solve_single_value_col(b, t))     { return true; }
-    if (details::solve_single_value_row(b, t))     { return true; }
-    if (details::solve_single_value_section(b, t)) { return true; }
-    return false;
-}
+template class basic_solver<details::singles_techniques>;
+template class basic_solver<details::subsets_techniques>;
+template class basic_solver<details::templates_techniques>;
 
 } // namespace engine
 
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "engine/board.h"
+
+namespace engine {
+namespace details {
+
+constexpr size_t UNIT_SIZE = board::ROW_SIZE;
+constexpr size_t UNITS_COUNT = board::ROW_SIZE + board::COL_SIZE + board::GRID_SIZE * board::GRID_SIZE;
+constexpr size_t UNITS_PER_CELL = 3;
+constexpr size_t PEERS_COUNT = 2 * (UNIT_SIZE - 1) + (board::GRID_SIZE - 1) * (board::GRID_SIZE - 1);
+
+// Units are numbered rows first, then columns, then boxes.
+constexpr size_t ROW_UNIT_BEGIN = 0;
+constexpr size_t COL_UNIT_BEGIN = ROW_UNIT_BEGIN + board::ROW_SIZE;
+constexpr size_t BOX_UNIT_BEGIN = COL_UNIT_BEGIN + board::COL_SIZE;
+
+// A band is three rows; its cells are bits (r % 3) * 9 + c of a 27-bit word.
+constexpr size_t BAND_SIZE = board::GRID_SIZE * board::COL_SIZE;
+constexpr size_t BANDS_COUNT = board::ROW_SIZE / board::GRID_SIZE;
+
+// Orders of three lines, and of the nine lines of a band or stack that keep its triples together.
+constexpr size_t TRIPLE_PERMUTATIONS_COUNT = 6;
+constexpr size_t LINE_PERMUTATIONS_COUNT = TRIPLE_PERMUTATIONS_COUNT * TRIPLE_PERMUTATIONS_COUNT
+                                         * TRIPLE_PERMUTATIONS_COUNT * TRIPLE_PERMUTATIONS_COUNT;
+
+using cell_idx_t = uint8_t;
+using cell_table_t = std::array<cell_idx_t, board::BOARD_SIZE>;
+using unit_cells_t = std::array<cell_idx_t, UNIT_SIZE>;
+using unit_table_t = std::array<unit_cells_t, UNITS_COUNT>;
+using cell_units_t = std::array<cell_idx_t, UNITS_PER_CELL>;
+using cell_units_table_t = std::array<cell_units_t, board::BOARD_SIZE>;
+using peers_t = std::array<cell_idx_t, PEERS_COUNT>;
+using peers_table_t = std::array<peers_t, board::BOARD_SIZE>;
+using cell_mask_t = std::array<uint64_t, 2>;
+using peer_masks_table_t = std::array<cell_mask_t, board::BOARD_SIZE>;
+using zobrist_cell_t = std::array<board::hash_t, UNIT_SIZE>;
+using zobrist_table_t = std::array<zobrist_cell_t, board::BOARD_SIZE>;
+using band_mask_t = uint32_t;
+using band_cells_table_t = std::array<band_mask_t, BAND_SIZE>;
+using band_cols_table_t = std::array<band_mask_t, board::COL_SIZE>;
+using band_triples_table_t = std::array<band_mask_t, board::GRID_SIZE>;
+using triple_perm_t = std::array<cell_idx_t, board::GRID_SIZE>;
+using triple_perms_table_t = std::array<triple_perm_t, TRIPLE_PERMUTATIONS_COUNT>;
+using line_perm_t = std::array<cell_idx_t, UNIT_SIZE>;
+using line_perms_table_t = std::array<line_perm_t, LINE_PERMUTATIONS_COUNT>;
+
+namespace tables {
+
+constexpr size_t box_of(const size_t r, const size_t c)
+{
+    return (r / board::GRID_SIZE) * board::GRID_SIZE + (c / board::GRID_SIZE);
+}
+
+constexpr cell_table_t make_cell_rows()
+{
+    cell_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        t[p] = static_cast<cell_idx_t>(p / board::COL_SIZE);
+    }
+    return t;
+}
+
+constexpr cell_table_t make_cell_cols()
+{
+    cell_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        t[p] = static_cast<cell_idx_t>(p % board::COL_SIZE);
+    }
+    return t;
+}
+
+constexpr cell_table_t make_cell_boxes()
+{
+    cell_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        t[p] = static_cast<cell_idx_t>(box_of(p / board::COL_SIZE, p % board::COL_SIZE));
+    }
+    return t;
+}
+
+constexpr unit_table_t make_unit_cells()
+{
+    unit_table_t t = {};
+    for (size_t i = 0; i < UNIT_SIZE; ++i) {
+        for (size_t j = 0; j < UNIT_SIZE; ++j) {
+            const size_t box_row = (i / board::GRID_SIZE) * board::GRID_SIZE + j / board::GRID_SIZE;
+            const size_t box_col = (i % board::GRID_SIZE) * board::GRID_SIZE + j % board::GRID_SIZE;
+
+            t[ROW_UNIT_BEGIN + i][j] = static_cast<cell_idx_t>(i * board::COL_SIZE + j);
+            t[COL_UNIT_BEGIN + i][j] = static_cast<cell_idx_t>(j * board::COL_SIZE + i);
+            t[BOX_UNIT_BEGIN + i][j] = static_cast<cell_idx_t>(box_row * board::COL_SIZE + box_col);
+        }
+    }
+    return t;
+}
+
+constexpr cell_units_table_t make_cell_units()
+{
+    cell_units_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        const size_t r = p / board::COL_SIZE;
+        const size_t c = p % board::COL_SIZE;
+        t[p][0] = static_cast<cell_idx_t>(ROW_UNIT_BEGIN + r);
+        t[p][1] = static_cast<cell_idx_t>(COL_UNIT_BEGIN + c);
+        t[p][2] = static_cast<cell_idx_t>(BOX_UNIT_BEGIN + box_of(r, c));
+    }
+    return t;
+}
+
+constexpr bool is_peer(const size_t p1, const size_t p2)
+{
+    const size_t r1 = p1 / board::COL_SIZE;
+    const size_t c1 = p1 % board::COL_SIZE;
+    const size_t r2 = p2 / board::COL_SIZE;
+    const size_t c2 = p2 % board::COL_SIZE;
+    return (p1 != p2) && ((r1 == r2) || (c1 == c2) || (box_of(r1, c1) == box_of(r2, c2)));
+}
+
+constexpr peers_table_t make_peers()
+{
+    peers_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        size_t count = 0;
+        for (size_t peer = 0; peer < board::BOARD_SIZE; ++peer) {
+            if (is_peer(p, peer)) {
+                t[p][count++] = static_cast<cell_idx_t>(peer);
+            }
+        }
+    }
+    return t;
+}
+
+constexpr peer_masks_table_t make_peer_masks()
+{
+    peer_masks_table_t t = {};
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        for (size_t peer = 0; peer < board::BOARD_SIZE; ++peer) {
+            if (is_peer(p, peer)) {
+                t[p][peer / 64] |= uint64_t(1) << (peer % 64);
+            }
+        }
+    }
+    return t;
+}
+
+// splitmix64, so the keys are fixed across builds and platforms.
+constexpr board::hash_t next_zobrist_key(board::hash_t& state)
+{
+    state += 0x9e3779b97f4a7c15ull;
+    board::hash_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+constexpr zobrist_table_t make_zobrist_keys()
+{
+    zobrist_table_t t = {};
+    board::hash_t state = 0;
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        for (size_t v = 0; v < UNIT_SIZE; ++v) {
+            t[p][v] = next_zobrist_key(state);
+        }
+    }
+    return t;
+}
+
+constexpr band_cells_table_t make_band_peers()
+{
+    band_cells_table_t t = {};
+    for (size_t i = 0; i < BAND_SIZE; ++i) {
+        for (size_t j = 0; j < BAND_SIZE; ++j) {
+            // Every band has the layout of the first one.
+            if (is_peer(i, j)) {
+                t[i] |= band_mask_t(1) << j;
+            }
+        }
+    }
+    return t;
+}
+
+constexpr band_cols_table_t make_band_cols()
+{
+    band_cols_table_t t = {};
+    for (size_t c = 0; c < board::COL_SIZE; ++c) {
+        for (size_t r = 0; r < board::GRID_SIZE; ++r) {
+            t[c] |= band_mask_t(1) << (r * board::COL_SIZE + c);
+        }
+    }
+    return t;
+}
+
+constexpr band_triples_table_t make_band_rows()
+{
+    band_triples_table_t t = {};
+    for (size_t r = 0; r < board::GRID_SIZE; ++r) {
+        t[r] = ((band_mask_t(1) << board::COL_SIZE) - 1) << (r * board::COL_SIZE);
+    }
+    return t;
+}
+
+constexpr band_triples_table_t make_band_boxes()
+{
+    band_triples_table_t t = {};
+    for (size_t i = 0; i < BAND_SIZE; ++i) {
+        t[(i % board::COL_SIZE) / board::GRID_SIZE] |= band_mask_t(1) << i;
+    }
+    return t;
+}
+
+constexpr triple_perms_table_t make_triple_perms()
+{
+    triple_perms_table_t t = {};
+    size_t count = 0;
+    for (size_t a = 0; a < board::GRID_SIZE; ++a) {
+        for (size_t b = 0; b < board::GRID_SIZE; ++b) {
+            const size_t c = board::GRID_SIZE - a - b;
+            if ((a != b) && (c < board::GRID_SIZE) && (c != a) && (c != b)) {
+                t[count++] = {static_cast<cell_idx_t>(a), static_cast<cell_idx_t>(b), static_cast<cell_idx_t>(c)};
+            }
+        }
+    }
+    return t;
+}
+
+// Index i orders the triples by i / 216 and the lines inside triple k by the k-th base-6 digit of i % 216.
+constexpr line_perms_table_t make_line_perms()
+{
+    constexpr triple_perms_table_t perms = make_triple_perms();
+
+    line_perms_table_t t = {};
+    for (size_t i = 0; i < LINE_PERMUTATIONS_COUNT; ++i) {
+        size_t inner = i % (LINE_PERMUTATIONS_COUNT / TRIPLE_PERMUTATIONS_COUNT);
+        const triple_perm_t& outer = perms[i / (LINE_PERMUTATIONS_COUNT / TRIPLE_PERMUTATIONS_COUNT)];
+        for (size_t k = 0; k < board::GRID_SIZE; ++k) {
+            const triple_perm_t& lines = perms[inner % TRIPLE_PERMUTATIONS_COUNT];
+            inner /= TRIPLE_PERMUTATIONS_COUNT;
+            for (size_t j = 0; j < board::GRID_SIZE; ++j) {
+                t[i][k * board::GRID_SIZE + j] = static_cast<cell_idx_t>(outer[k] * board::GRID_SIZE + lines[j]);
+            }
+        }
+    }
+    return t;
+}
+
+} // namespace tables
+
+inline constexpr cell_table_t CELL_ROW = tables::make_cell_rows();
+inline constexpr cell_table_t CELL_COL = tables::make_cell_cols();
+inline constexpr cell_table_t CELL_BOX = tables::make_cell_boxes();
+
+inline constexpr unit_table_t UNIT_CELLS = tables::make_unit_cells();
+inline constexpr cell_units_table_t CELL_UNITS = tables::make_cell_units();
+
+inline constexpr peers_table_t PEERS = tables::make_peers();
+inline constexpr peer_masks_table_t PEER_MASKS = tables::make_peer_masks();
+
+// Key of digit v (1-based) placed in cell p.
+inline constexpr zobrist_table_t ZOBRIST_KEYS = tables::make_zobrist_keys();
+
+// Row and box peers of a band cell inside the band, and the cells of a column, row and box.
+inline constexpr band_mask_t BAND_ALL_CELLS = (band_mask_t(1) << BAND_SIZE) - 1;
+inline constexpr band_cells_table_t BAND_PEERS = tables::make_band_peers();
+inline constexpr band_cols_table_t BAND_COLS = tables::make_band_cols();
+inline constexpr band_triples_table_t BAND_ROWS = tables::make_band_rows();
+inline constexpr band_triples_table_t BAND_BOXES = tables::make_band_boxes();
+
+inline constexpr triple_perms_table_t TRIPLE_PERMUTATIONS = tables::make_triple_perms();
+inline constexpr line_perms_table_t LINE_PERMUTATIONS = tables::make_line_perms();
+
+inline bool is_in_mask(const cell_mask_t& m, const size_t p) { return (m[p / 64] >> (p % 64)) & 1; }
+
+} // namespace details
+} // namespace engine
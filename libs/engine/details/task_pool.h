@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace engine {
+namespace details {
+
+// Tasks are plain values kept in per-worker slot vectors, so pushing a task reuses the slots of
+// finished ones instead of allocating a closure.
+template<typename TTask>
+class task_pool final
+{
+public:
+    using task_t = TTask;
+
+public:
+    // All queues allocate from p_mr under their own locks, so it has to be thread safe.
+    explicit task_pool(const size_t workers,
+                       std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    task_pool(const task_pool&) = delete;
+    task_pool& operator=(const task_pool&) = delete;
+
+    // Owner pushes and pops at the back, thieves take the oldest (largest) tasks from the front.
+    void push(const size_t worker, TTask task);
+
+    // Runs fn(worker, task) for queued tasks on workers_count() threads, the calling one
+    // included, until none is left. Workers without a task sleep until one is pushed.
+    template<typename TFn>
+    void run(TFn fn);
+
+    size_t workers_count() const { return m_queues.size(); }
+
+private:
+    struct queue final
+    {
+        explicit queue(std::pmr::memory_resource* p_mr)
+            : tasks(p_mr)
+        {}
+
+        bool empty() const { return (head == tasks.size()); }
+
+        std::mutex mutex;
+        // Slots before head were stolen; they are reused once the queue runs empty.
+        std::pmr::vector<TTask> tasks;
+        size_t head = 0;
+    };
+
+private:
+    bool pop(const size_t worker, TTask& task);
+
+    bool steal(const size_t worker, TTask& task);
+
+    void wait();
+
+    template<typename TFn>
+    void work(const size_t worker, TFn& fn);
+
+private:
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::atomic<size_t> m_pending;
+    std::atomic<size_t> m_queued;
+
+    std::mutex m_idle_mutex;
+    std::condition_variable m_idle_cv;
+    std::atomic<size_t> m_idle_count;
+};
+
+template<typename TTask>
+task_pool<TTask>::task_pool(const size_t workers, std::pmr::memory_resource* p_mr)
+    : m_pending(0)
+    , m_queued(0)
+    , m_idle_count(0)
+{
+    assert(workers > 0);
+    for (size_t i = 0; i < workers; ++i) {
+        m_queues.emplace_back(std::make_unique<queue>(p_mr));
+    }
+}
+
+template<typename TTask>
+bool task_pool<TTask>::pop(const size_t worker, TTask& task)
+{
+    queue& q = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.empty()) {
+        return false;
+    }
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    if (q.empty()) {
+        q.tasks.clear();
+        q.head = 0;
+    }
+    m_queued.fetch_sub(1);
+    return true;
+}
+
+template<typename TTask>
+void task_pool<TTask>::push(const size_t worker, TTask task)
+{
+    assert(worker < m_queues.size());
+
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        queue& q = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        // Counted under the queue lock, before the task can be popped or stolen, so the count never
+        // drops below zero. Sequentially consistent with the idle count in wait(): either the
+        // sleeper sees the task or this thread sees the sleeper.
+        m_queued.fetch_add(1);
+        q.tasks.emplace_back(std::move(task));
+    }
+
+    if (m_idle_count.load() != 0) {
+        { std::lock_guard<std::mutex> lock(m_idle_mutex); }
+        m_idle_cv.notify_one();
+    }
+}
+
+template<typename TTask>
+template<typename TFn>
+void task_pool<TTask>::run(TFn fn)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(m_queues.size() - 1);
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        threads.emplace_back([this, &fn, i]() -> void { work(i, fn); });
+    }
+    work(0, fn);
+    for (std::thread& th : threads) {
+        th.join();
+    }
+}
+
+template<typename TTask>
+bool task_pool<TTask>::steal(const size_t worker, TTask& task)
+{
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        queue& q = *m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (! q.empty()) {
+            task = std::move(q.tasks[q.head]);
+            ++q.head;
+            if (q.empty()) {
+                q.tasks.clear();
+                q.head = 0;
+            }
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename TTask>
+void task_pool<TTask>::wait()
+{
+    std::unique_lock<std::mutex> lock(m_idle_mutex);
+    m_idle_count.fetch_add(1);
+    m_idle_cv.wait(lock, [this]() -> bool {
+        return (m_queued.load() != 0) || (m_pending.load() == 0);
+    });
+    m_idle_count.fetch_sub(1);
+}
+
+template<typename TTask>
+template<typename TFn>
+void task_pool<TTask>::work(const size_t worker, TFn& fn)
+{
+    // A task pushes its children before it is accounted as done, so zero pending means no more work.
+    TTask task;
+    while (m_pending.load(std::memory_order_acquire) != 0) {
+        if (pop(worker, task) || steal(worker, task)) {
+            fn(worker, task);
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                { std::lock_guard<std::mutex> lock(m_idle_mutex); }
+                m_idle_cv.notify_all();
+            }
+        } else {
+            wait();
+        }
+    }
+}
+
+} // namespace details
+} // namespace engine
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "engine/board.h"
+#include "engine/counters.h"
+#include "engine/details/templates.h"
+#include "engine/details/utils.h"
+
+namespace engine {
+namespace details {
+
+enum class technique_level
+{
+    EASY,
+    MEDIUM,
+    HARD
+};
+
+struct single_cell_technique final
+{
+    static constexpr technique_id id = technique_id::SINGLE_CELL;
+    static constexpr technique_level level = technique_level::EASY;
+    static bool apply(board& b, const board::tag_t t) { return solve_single_cell(b, t); }
+};
+
+struct single_value_col_technique final
+{
+    static constexpr technique_id id = technique_id::SINGLE_VALUE_COL;
+    static constexpr technique_level level = technique_level::MEDIUM;
+    static bool apply(board& b, const board::tag_t t) { return solve_single_value_col(b, t); }
+};
+
+struct single_value_row_technique final
+{
+    static constexpr technique_id id = technique_id::SINGLE_VALUE_ROW;
+    static constexpr technique_level level = technique_level::MEDIUM;
+    static bool apply(board& b, const board::tag_t t) { return solve_single_value_row(b, t); }
+};
+
+struct single_value_section_technique final
+{
+    static constexpr technique_id id = technique_id::SINGLE_VALUE_SECTION;
+    static constexpr technique_level level = technique_level::MEDIUM;
+    static bool apply(board& b, const board::tag_t t) { return solve_single_value_section(b, t); }
+};
+
+struct naked_pairs_technique final
+{
+    static constexpr technique_id id = technique_id::NAKED_PAIRS;
+    static constexpr technique_level level = technique_level::HARD;
+    static bool apply(board& b, const board::tag_t t) { return mark_naked_pairs(b, t); }
+};
+
+struct hidden_pairs_col_technique final
+{
+    static constexpr technique_id id = technique_id::HIDDEN_PAIRS_COL;
+    static constexpr technique_level level = technique_level::HARD;
+    static bool apply(board& b, const board::tag_t t) { return mark_hidden_pairs_col(b, t); }
+};
+
+struct hidden_pairs_row_technique final
+{
+    static constexpr technique_id id = technique_id::HIDDEN_PAIRS_ROW;
+    static constexpr technique_level level = technique_level::HARD;
+    static bool apply(board& b, const board::tag_t t) { return mark_hidden_pairs_row(b, t); }
+};
+
+// Costs a scan of the template table per digit, so it goes last in a list.
+struct templates_technique final
+{
+    static constexpr technique_id id = technique_id::TEMPLATES;
+    static constexpr technique_level level = technique_level::HARD;
+    static bool apply(board& b, const board::tag_t t) { return mark_templates(b, t); }
+};
+
+template<typename... TTechniques>
+struct technique_list final
+{};
+
+struct null_logger final
+{
+    void operator()(const technique_level, const board::tag_t) const {}
+};
+
+template<typename TTechniqueList>
+struct pipeline;
+
+// Applies the first technique of the list that makes progress, like the former chains of if calls.
+template<typename... TTechniques>
+struct pipeline<technique_list<TTechniques...>> final
+{
+    static bool apply(board& b, const board::tag_t t)
+    {
+        null_logger logger;
+        return apply(b, t, logger);
+    }
+
+    template<typename TLogger>
+    static bool apply(board& b, const board::tag_t t, TLogger& logger)
+    {
+        return (apply_one<TTechniques>(b, t, logger) || ...);
+    }
+
+private:
+    template<typename TTechnique, typename TLogger>
+    static bool apply_one(board& b, const board::tag_t t, TLogger& logger)
+    {
+        if (TTechnique::apply(b, t)) {
+            ENGINE_COUNT_TECHNIQUE(TTechnique::id);
+            logger(TTechnique::level, t);
+            return true;
+        }
+        return false;
+    }
+};
+
+using singles_techniques = technique_list<single_cell_technique,
+                                          single_value_col_technique,
+                                          single_value_row_technique,
+                                          single_value_section_technique>;
+
+using subsets_techniques = technique_list<single_cell_technique,
+                                          single_value_col_technique,
+                                          single_value_row_technique,
+                                          single_value_section_technique,
+                                          naked_pairs_technique,
+                                          hidden_pairs_col_technique,
+                                          hidden_pairs_row_technique>;
+
+using templates_techniques = technique_list<single_cell_technique,
+                                            single_value_col_technique,
+                                            single_value_row_technique,
+                                            single_value_section_technique,
+                                            naked_pairs_technique,
+                                            hidden_pairs_col_technique,
+                                            hidden_pairs_row_technique,
+                                            templates_technique>;
+
+using singles_pipeline = pipeline<singles_techniques>;
+using subsets_pipeline = pipeline<subsets_techniques>;
+using templates_pipeline = pipeline<templates_techniques>;
+
+} // namespace details
+} // namespace engine
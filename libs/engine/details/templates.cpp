@@ -0,0 +1,125 @@
+#include "engine/details/templates.h"
+
+namespace engine {
+namespace details {
+namespace {
+
+using lines_mask_t = uint16_t;
+
+void add_templates(std::vector<template_t>& templates, template_t& cells, const size_t row,
+                   const lines_mask_t used_cols, const lines_mask_t used_boxes)
+{
+    if (row == board::ROW_SIZE) {
+        templates.push_back(cells);
+        return;
+    }
+
+    const size_t band = row / board::GRID_SIZE;
+    for (size_t c = 0; c < board::COL_SIZE; ++c) {
+        const lines_mask_t col = lines_mask_t(1) << c;
+        const lines_mask_t box = lines_mask_t(1) << (band * board::GRID_SIZE + c / board::GRID_SIZE);
+        if (((used_cols & col) != 0) || ((used_boxes & box) != 0)) {
+            continue;
+        }
+        const band_mask_t cell = band_mask_t(1) << ((row % board::GRID_SIZE) * board::COL_SIZE + c);
+        cells[band] |= cell;
+        add_templates(templates, cells, row + 1, used_cols | col, used_boxes | box);
+        cells[band] &= ~cell;
+    }
+}
+
+std::vector<template_t> make_templates()
+{
+    std::vector<template_t> templates;
+    templates.reserve(TEMPLATES_COUNT);
+    template_t cells = {};
+    add_templates(templates, cells, 0, 0, 0);
+    return templates;
+}
+
+} // <anonymous> namespace
+
+const std::vector<template_t>& all_templates()
+{
+    static const std::vector<template_t> templates = make_templates();
+    return templates;
+}
+
+template_overlay overlay_templates(const board& b, const board::value_t v)
+{
+    template_t placed = {};
+    template_t allowed = {};
+    size_t placed_count = 0;
+    for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+        const band_mask_t cell = band_mask_t(1) << (p % BAND_SIZE);
+        if (! b.is_set_value(p)) {
+            allowed[p / BAND_SIZE] |= b.is_available(p, v) ? cell : 0;
+        } else if (b.value(p) == v) {
+            allowed[p / BAND_SIZE] |= cell;
+            placed[p / BAND_SIZE] |= cell;
+            ++placed_count;
+        }
+    }
+
+    template_overlay res;
+    if (placed_count == board::ROW_SIZE) {
+        res.count = 1;
+        res.cover = placed;
+        res.forced = placed;
+        return res;
+    }
+
+    res.forced = {BAND_ALL_CELLS, BAND_ALL_CELLS, BAND_ALL_CELLS};
+    const std::vector<template_t>& templates = all_templates();
+    for (size_t g = 0; g < TEMPLATE_GROUPS_COUNT; ++g) {
+        // The first template of a group has the rows 0 and 1 cells of all of them.
+        const template_t* p_begin = templates.data() + g * TEMPLATE_GROUP_SIZE;
+        const band_mask_t head = (*p_begin)[0] & (BAND_ROWS[0] | BAND_ROWS[1]);
+        if ((head & ~allowed[0]) != 0) {
+            continue;
+        }
+
+        for (const template_t* p_t = p_begin; p_t != p_begin + TEMPLATE_GROUP_SIZE; ++p_t) {
+            const template_t& tmpl = *p_t;
+            bool is_fit = true;
+            for (size_t band = 0; band < BANDS_COUNT; ++band) {
+                is_fit = is_fit && ((tmpl[band] & ~allowed[band]) == 0) && ((placed[band] & ~tmpl[band]) == 0);
+            }
+            if (! is_fit) {
+                continue;
+            }
+            ++res.count;
+            for (size_t band = 0; band < BANDS_COUNT; ++band) {
+                res.cover[band] |= tmpl[band];
+                res.forced[band] &= tmpl[band];
+            }
+        }
+    }
+    if (res.count == 0) {
+        res.forced = {};
+    }
+    return res;
+}
+
+bool mark_templates(board& b, const board::tag_t t)
+{
+    bool is_found = false;
+    for (board::value_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
+        const template_overlay o = overlay_templates(b, v);
+        for (size_t p = 0; p < board::BOARD_SIZE; ++p) {
+            if (b.is_set_value(p)) {
+                continue;
+            }
+            const band_mask_t cell = band_mask_t(1) << (p % BAND_SIZE);
+            if ((o.forced[p / BAND_SIZE] & cell) != 0) {
+                is_found = b.set_value(p, v, t) || is_found;
+            } else if ((o.cover[p / BAND_SIZE] & cell) == 0) {
+                is_found = b.set_impossible(p, v, t) || is_found;
+            }
+        }
+    }
+    return is_found;
+}
+
+} // namespace details
+} // namespace engine
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/details/tables.h"
+
+namespace engine {
+namespace details {
+
+// A template is a placement of one digit on the whole grid: a cell in every row, column and box.
+// Cells are three 27-bit band words, like in bitboard_solver.
+using template_t = std::array<band_mask_t, BANDS_COUNT>;
+
+constexpr size_t TEMPLATES_COUNT = 46656;
+
+// Templates are generated row by row in column order, so the ones with the same cells in rows 0
+// and 1 are contiguous groups.
+constexpr size_t TEMPLATE_GROUPS_COUNT = 54;
+constexpr size_t TEMPLATE_GROUP_SIZE = TEMPLATES_COUNT / TEMPLATE_GROUPS_COUNT;
+
+// Built on the first call.
+const std::vector<template_t>& all_templates();
+
+// Templates of a digit that keep its placed cells and avoid its eliminated ones.
+struct template_overlay final
+{
+    size_t count = 0;
+    // Cells of any of the templates; the digit is impossible elsewhere.
+    template_t cover = {};
+    // Cells of all of the templates; the digit is forced there. Empty when count is zero.
+    template_t forced = {};
+};
+
+template_overlay overlay_templates(const board& b, const board::value_t v);
+
+// Sets the forced cells and removes the uncovered candidates of every digit.
+bool mark_templates(board& b, const board::tag_t t);
+
+} // namespace details
+} // namespace engine
@@ -0,0 +1,223 @@
+#include "engine/text.h"
+#include "engine/details/cpu_dispatch.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(ENGINE_CPU_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace engine {
+namespace {
+
+static_assert(sizeof(board::grid_t) == board::BOARD_SIZE, "grid cells must be contiguous");
+
+constexpr unsigned char MAX_DIGIT = 9;
+
+struct kernels final
+{
+    // Returns the index of the first character that is not a digit or '.', or LINE_SIZE.
+    size_t (*to_cells)(const char* p_in, char* p_cells);
+    void (*to_chars)(const char* p_cells, char* p_out, const char blank);
+};
+
+// Returns the index of the first character that is not a digit or '.', or n.
+size_t to_cells_scalar(const char* p_in, char* p_cells, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned char v = (p_in[i] == '.') ? 0 : static_cast<unsigned char>(p_in[i] - '0');
+        if (v > MAX_DIGIT) {
+            return i;
+        }
+        p_cells[i] = static_cast<char>(v);
+    }
+    return n;
+}
+
+// Converts from i on, the wider builds hand over the tail shorter than their vectors.
+ENGINE_KERNEL_INLINE size_t to_cells_tail(const char* p_in, char* p_cells, size_t i)
+{
+#if defined(__SSE2__)
+    const __m128i zero_ch = _mm_set1_epi8('0');
+    const __m128i dot_ch = _mm_set1_epi8('.');
+    const __m128i max_digit = _mm_set1_epi8(MAX_DIGIT);
+    for (; i + sizeof(__m128i) <= text::LINE_SIZE; i += sizeof(__m128i)) {
+        const __m128i ch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_in + i));
+        // '.' becomes 0, anything but a digit wraps past 9.
+        const __m128i v = _mm_andnot_si128(_mm_cmpeq_epi8(ch, dot_ch), _mm_sub_epi8(ch, zero_ch));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, max_digit), v)) != 0xffff) {
+            return i + to_cells_scalar(p_in + i, p_cells + i, sizeof(__m128i));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_cells + i), v);
+    }
+#endif
+    return i + to_cells_scalar(p_in + i, p_cells + i, text::LINE_SIZE - i);
+}
+
+ENGINE_KERNEL_INLINE void to_chars_tail(const char* p_cells, char* p_out, const char blank, size_t i)
+{
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i zero_ch = _mm_set1_epi8('0');
+    const __m128i blank_ch = _mm_set1_epi8(blank);
+    for (; i + sizeof(__m128i) <= text::LINE_SIZE; i += sizeof(__m128i)) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_cells + i));
+        const __m128i is_blank = _mm_cmpeq_epi8(v, zero);
+        const __m128i ch = _mm_or_si128(_mm_and_si128(is_blank, blank_ch),
+                                        _mm_andnot_si128(is_blank, _mm_add_epi8(v, zero_ch)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p_out + i), ch);
+    }
+#endif
+    for (; i < text::LINE_SIZE; ++i) {
+        p_out[i] = (p_cells[i] == 0) ? blank : static_cast<char>('0' + p_cells[i]);
+    }
+}
+
+size_t to_cells_generic(const char* p_in, char* p_cells)
+{
+    return to_cells_tail(p_in, p_cells, 0);
+}
+
+void to_chars_generic(const char* p_cells, char* p_out, const char blank)
+{
+    to_chars_tail(p_cells, p_out, blank, 0);
+}
+
+#if defined(ENGINE_CPU_DISPATCH)
+ENGINE_TARGET_AVX2 size_t to_cells_avx2(const char* p_in, char* p_cells)
+{
+    const __m256i zero_ch = _mm256_set1_epi8('0');
+    const __m256i dot_ch = _mm256_set1_epi8('.');
+    const __m256i max_digit = _mm256_set1_epi8(MAX_DIGIT);
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= text::LINE_SIZE; i += sizeof(__m256i)) {
+        const __m256i ch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_in + i));
+        const __m256i v = _mm256_andnot_si256(_mm256_cmpeq_epi8(ch, dot_ch), _mm256_sub_epi8(ch, zero_ch));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, max_digit), v)) != -1) {
+            return i + to_cells_scalar(p_in + i, p_cells + i, sizeof(__m256i));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_cells + i), v);
+    }
+    return to_cells_tail(p_in, p_cells, i);
+}
+
+ENGINE_TARGET_AVX2 void to_chars_avx2(const char* p_cells, char* p_out, const char blank)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i zero_ch = _mm256_set1_epi8('0');
+    const __m256i blank_ch = _mm256_set1_epi8(blank);
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= text::LINE_SIZE; i += sizeof(__m256i)) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_cells + i));
+        const __m256i is_blank = _mm256_cmpeq_epi8(v, zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p_out + i),
+                            _mm256_blendv_epi8(_mm256_add_epi8(v, zero_ch), blank_ch, is_blank));
+    }
+    to_chars_tail(p_cells, p_out, blank, i);
+}
+#endif
+
+#if defined(ENGINE_CPU_DISPATCH)
+constexpr details::kernel_table_t<kernels> KERNELS = {{
+    {to_cells_generic, to_chars_generic}, {to_cells_generic, to_chars_generic},
+    {to_cells_avx2, to_chars_avx2}, {to_cells_avx2, to_chars_avx2}
+}};
+#else
+constexpr details::kernel_table_t<kernels> KERNELS = {{
+    {to_cells_generic, to_chars_generic}, {to_cells_generic, to_chars_generic},
+    {to_cells_generic, to_chars_generic}, {to_cells_generic, to_chars_generic}
+}};
+#endif
+
+const kernels& get_kernels()
+{
+    return details::select_kernel(KERNELS);
+}
+
+} // <anonymous> namespace
+
+std::string text::error_to_str(const error e)
+{
+    if (e == error::NONE) {
+        return "NONE";
+    } else if (e == error::SHORT_LINE) {
+        return "SHORT_LINE";
+    } else if (e == error::LONG_LINE) {
+        return "LONG_LINE";
+    }
+    return "BAD_CHAR";
+}
+
+void text::format(const grid_t& g, char* p_out, const char blank)
+{
+    get_kernels().to_chars(reinterpret_cast<const char*>(g.data()), p_out, blank);
+}
+
+std::string text::format(const grid_t& g, const char blank)
+{
+    std::string line(LINE_SIZE, blank);
+    format(g, line.data(), blank);
+    return line;
+}
+
+text::parse_result text::parse(std::string_view line, grid_t& g)
+{
+    parse_result res;
+    if (line.size() < LINE_SIZE) {
+        res.code = error::SHORT_LINE;
+        res.offset = line.size();
+        return res;
+    }
+
+    // g is left untouched on errors.
+    grid_t cells;
+    const size_t bad = get_kernels().to_cells(line.data(), reinterpret_cast<char*>(cells.data()));
+    if (bad != LINE_SIZE) {
+        res.code = error::BAD_CHAR;
+        res.offset = bad;
+        return res;
+    }
+    if (line.size() > LINE_SIZE) {
+        res.code = error::LONG_LINE;
+        res.offset = LINE_SIZE;
+        return res;
+    }
+
+    g = cells;
+    return res;
+}
+
+text::parse_result text::parse_lines(std::string_view buf, std::vector<grid_t>& grids)
+{
+    grids.reserve(grids.size() + buf.size() / (LINE_SIZE + 1));
+
+    parse_result res;
+    size_t pos = 0;
+    while (pos < buf.size()) {
+        size_t end = buf.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = buf.size();
+        }
+        size_t line_end = end;
+        if ((line_end > pos) && (buf[line_end - 1] == '\r')) {
+            --line_end;
+        }
+
+        if (line_end > pos) {
+            grid_t g;
+            const parse_result line_res = parse(buf.substr(pos, line_end - pos), g);
+            if (line_res.code != error::NONE) {
+                res.code = line_res.code;
+                res.offset = pos + line_res.offset;
+                return res;
+            }
+            grids.push_back(g);
+            ++res.lines;
+        }
+        pos = end + 1;
+    }
+    return res;
+}
+
+} // namespace engine
@@ -0,0 +1,65 @@
+#include "engine/details/transposition_table.h"
+
+namespace engine {
+namespace details {
+
+transposition_table::transposition_table(const size_t entries, std::pmr::memory_resource* p_mr)
+    : m_entries(p_mr)
+{
+    resize(entries);
+}
+
+void transposition_table::clear()
+{
+    for (entry& e : m_entries) {
+        e = entry();
+    }
+}
+
+bool transposition_table::find(const board::hash_t h, const size_t limit, size_t& count) const
+{
+    if (m_entries.empty()) {
+        return false;
+    }
+
+    const entry& e = m_entries[h & (m_capacity - 1)];
+    if ((! e.is_used) || (e.hash != h)) {
+        return false;
+    }
+    if ((! e.is_exact) && (e.count < limit)) {
+        return false;
+    }
+    count = e.count;
+    return true;
+}
+
+void transposition_table::resize(const size_t entries)
+{
+    size_t capacity = (entries != 0) ? 1 : 0;
+    while (capacity < entries) {
+        capacity <<= 1;
+    }
+
+    m_capacity = capacity;
+    m_entries.clear();
+    m_entries.shrink_to_fit();
+}
+
+void transposition_table::store(const board::hash_t h, const size_t count, const bool is_exact)
+{
+    if (m_capacity == 0) {
+        return;
+    }
+    if (m_entries.empty()) {
+        m_entries.resize(m_capacity);
+    }
+
+    entry& e = m_entries[h & (m_capacity - 1)];
+    e.hash = h;
+    e.count = count;
+    e.is_exact = is_exact;
+    e.is_used = true;
+}
+
+} // namespace details
+} // namespace engine
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "engine/board.h"
+
+namespace engine {
+namespace details {
+
+// Direct-mapped cache of solution counts keyed by board::hash(). The count of a partial board
+// depends on its placed values only, so entries stay valid across searches and grids.
+class transposition_table final
+{
+public:
+    static constexpr size_t DEFAULT_SIZE = 1 << 14;
+
+    explicit transposition_table(const size_t entries = DEFAULT_SIZE,
+                                 std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    void clear();
+
+    // Exact counts answer any limit, truncated ones only limits they reach.
+    bool find(const board::hash_t h, const size_t limit, size_t& count) const;
+
+    bool is_enabled() const { return (m_capacity != 0); }
+
+    // Rounded up to a power of two, zero disables the table.
+    void resize(const size_t entries);
+
+    size_t size() const { return m_capacity; }
+
+    // Storage is allocated by the first store, the newest entry replaces an older one.
+    void store(const board::hash_t h, const size_t count, const bool is_exact);
+
+private:
+    struct entry final
+    {
+        board::hash_t hash = 0;
+        size_t count = 0;
+        bool is_exact = false;
+        bool is_used = false;
+    };
+
+private:
+    std::pmr::vector<entry> m_entries;
+    size_t m_capacity = 0;
+};
+
+} // namespace details
+} // namespace engine
@@ -1,7 +1,10 @@
 #include <cassert>
-#include <cstdlib>
+#include <cstdint>
 #include <ctime>
+#include <functional>
+#include <thread>
 
+#include "engine/counters.h"
 #include "engine/details/utils.h"
 
 namespace engine {
@@ -31,16 +34,22 @@ guess_t find_guess_cell(const is_set_fn_t& is_set_fn, const is_poss_fn_t& is_pos
             }
         }
     }
+    ENGINE_COUNT_IF(guesses, guess.is_valid());
     return guess;
 }
 
-void init_random()
+random_engine_t& random_engine()
 {
-    static bool is_once = true;
-    if (is_once) {
-        is_once = false;
-        std::srand(std::time(nullptr));
-    }
+    // Every thread owns its engine, so concurrent searches neither race nor share a sequence.
+    thread_local random_engine_t engine(
+        static_cast<random_engine_t::result_type>(std::time(nullptr)) ^
+        static_cast<random_engine_t::result_type>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+    return engine;
+}
+
+void seed_random(const random_engine_t::result_type seed)
+{
+    random_engine().seed(seed);
 }
 
 bool mark_hidden_pairs_col(board& b, const board::tag_t t)
@@ -49,9 +58,10 @@ bool mark_hidden_pairs_col(board& b, const board::tag_t t)
 
     const has_two_poss_fn_t has_poss_fn = [&b](size_t c, size_t& r1, size_t& r2,
                                                board::value_t v) -> bool {
+        const unit_cells_t& col_cells = UNIT_CELLS[COL_UNIT_BEGIN + c];
         size_t count = 0;
         for (size_t r = 0; r < board::ROW_SIZE; ++r) {
-            if (b.is_available(to_position(r, c), v)) {
+            if (b.is_available(col_cells[r], v)) {
                 if (r1 == board::ROW_SIZE) {
                     r1 = r;
                 } else if (r2 == board::ROW_SIZE) {
@@ -87,12 +97,12 @@ bool mark_hidden_pairs_col(board& b, const board::tag_t t)
                         continue;
                     }
 
-                    const size_t p1 = to_position(r1, c);
+                    const size_t p1 = UNIT_CELLS[COL_UNIT_BEGIN + c][r1];
                     if (b.is_available(p1, v3)) {
                         b.set_impossible(p1, v3, t);
                         is_found = true;
                     }
-                    const size_t p2 = to_position(r2, c);
+                    const size_t p2 = UNIT_CELLS[COL_UNIT_BEGIN + c][r2];
                     if (b.is_available(p2, v3)) {
                         b.set_impossible(p2, v3, t);
                         is_found = true;
@@ -110,9 +120,10 @@ bool mark_hidden_pairs_row(board& b, const board::tag_t t)
 
     const has_two_poss_fn_t has_poss_fn = [&b](size_t r, size_t& c1, size_t& c2,
                                                board::value_t v) -> bool {
+        const unit_cells_t& row_cells = UNIT_CELLS[ROW_UNIT_BEGIN + r];
         size_t count = 0;
         for (size_t c = 0; c < board::COL_SIZE; ++c) {
-            if (b.is_available(to_position(r, c), v)) {
+            if (b.is_available(row_cells[c], v)) {
                 if (c1 == board::COL_SIZE) {
                     c1 = c;
                 } else if (c2 == board::COL_SIZE) {
@@ -148,12 +159,12 @@ bool mark_hidden_pairs_row(board& b, const board::tag_t t)
                         continue;
                     }
 
-                    const size_t p1 = to_position(r, c1);
+                    const size_t p1 = UNIT_CELLS[ROW_UNIT_BEGIN + r][c1];
                     if (b.is_available(p1, v3)) {
                         b.set_impossible(p1, v3, t);
                         is_found = true;
                     }
-                    const size_t p2 = to_position(r, c2);
+                    const size_t p2 = UNIT_CELLS[ROW_UNIT_BEGIN + r][c2];
                     if (b.is_available(p2, v3)) {
                         b.set_impossible(p2, v3, t);
                         is_found = true;
@@ -169,7 +180,6 @@ bool mark_naked_pairs(board& b, const board::tag_t t)
 {
     using has_two_possibles_fn_t = std::function<bool(size_t)>;
     using mark_pair_fn_t = std::function<bool(size_t,size_t,size_t)>;
-    using pos_to_grid_start_fn_t = std::function<size_t(size_t)>;
 
     const std::function<bool(size_t,size_t)> are_same_fn =
         [&b](size_t p1, size_t p2) -> bool {
@@ -201,25 +211,15 @@ bool mark_naked_pairs(board& b, const board::tag_t t)
         }
         return is_found;
     };
-    const pos_to_grid_start_fn_t start_col_fn = [](size_t p) -> size_t {
-        return grid_start_col(col_by_position(p));
-    };
-    const pos_to_grid_start_fn_t start_row_fn = [](size_t p) -> size_t {
-        return grid_start_row(row_by_position(p));
-    };
-
     bool is_found = false;
     for (size_t p1 = 0; p1 < board::BOARD_SIZE; ++p1) {
         if (! has_two_possibles_fn(p1)) {
             continue;
         }
 
-        const size_t c1 = col_by_position(p1);
-        const size_t r1 = row_by_position(p1);
-        const size_t st_c1 = grid_start_col(c1);
-        const size_t st_r1 = grid_start_row(r1);
-        assert(st_c1 == start_col_fn(p1));
-        assert(st_r1 == start_row_fn(p1));
+        const size_t c1 = CELL_COL[p1];
+        const size_t r1 = CELL_ROW[p1];
+        const size_t box1 = CELL_BOX[p1];
         for (size_t p2 = p1; p2 < board::BOARD_SIZE; ++p2) {
             if (p1 == p2) {
                 continue;
@@ -232,25 +232,23 @@ bool mark_naked_pairs(board& b, const board::tag_t t)
             }
 
             // Check rows.
-            if (r1 == row_by_position(p2)) {
-                for (size_t c2 = 0; c2 < board::COL_SIZE; ++c2) {
-                    if (mark_pair_fn(p1, p2, to_position(r1, c2))) {
+            if (r1 == CELL_ROW[p2]) {
+                for (const cell_idx_t p3 : UNIT_CELLS[ROW_UNIT_BEGIN + r1]) {
+                    if (mark_pair_fn(p1, p2, p3)) {
                         is_found = true;
                     }
                 }
             }
             // Check cols.
-            if (c1 == col_by_position(p2)) {
-                for (size_t r2 = 0; r2 < board::ROW_SIZE; ++r2) {
-                    is_found = mark_pair_fn(p1, p2, to_position(r2, c1));
+            if (c1 == CELL_COL[p2]) {
+                for (const cell_idx_t p3 : UNIT_CELLS[COL_UNIT_BEGIN + c1]) {
+                    is_found = mark_pair_fn(p1, p2, p3);
                 }
             }
             // Check grid.
-            if ((st_c1 == start_col_fn(p2)) && (st_r1 == start_row_fn(p2))) {
-                for (size_t r3 = st_r1; r3 < st_r1 + board::GRID_SIZE; ++r3) {
-                    for (size_t c3 = st_c1; c3 < st_c1 + board::GRID_SIZE; ++c3) {
-                        is_found = mark_pair_fn(p1, p2, to_position(r3, c3));
-                    }
+            if (box1 == CELL_BOX[p2]) {
+                for (const cell_idx_t p3 : UNIT_CELLS[BOX_UNIT_BEGIN + box1]) {
+                    is_found = mark_pair_fn(p1, p2, p3);
                 }
             }
         }
@@ -289,8 +287,7 @@ bool solve_single_value_col(board& b, const board::tag_t t)
             size_t count = 0;
             size_t possible_pos = 0;
             board::value_t possible_val = 0;
-            for (size_t r = 0; r < board::ROW_SIZE; ++r) {
-                const size_t p = to_position(r, c);
+            for (const cell_idx_t p : UNIT_CELLS[COL_UNIT_BEGIN + c]) {
                 if (! b.is_set_value(p) && b.is_possible(p, v)) {
                     ++count;
                     possible_pos = p;
@@ -314,8 +311,7 @@ bool solve_single_value_row(board& b, const board::tag_t t)
             size_t count = 0;
             size_t possible_pos = 0;
             board::value_t possible_val = 0;
-            for (size_t c = 0; c < board::COL_SIZE; ++c) {
-                const size_t p = to_position(r, c);
+            for (const cell_idx_t p : UNIT_CELLS[ROW_UNIT_BEGIN + r]) {
                 if (! b.is_set_value(p) && b.is_possible(p, v)) {
                     ++count;
                     possible_pos = p;
@@ -334,27 +330,22 @@ bool solve_single_value_row(board& b, const board::tag_t t)
 bool solve_single_value_section(board& b, const board::tag_t t)
 {
     for (size_t s = 0; s < board::ROW_SIZE; ++s) {
-        const size_t start_row = (s / board::GRID_SIZE) * board::GRID_SIZE;
-        const size_t start_col = (s % board::GRID_SIZE) * board::GRID_SIZE;
-        for (size_t r = start_row; r < start_row + board::GRID_SIZE; ++r) {
-            for (size_t c = start_col; c < start_col + board::GRID_SIZE; ++c) {
-                const size_t p = to_position(r, c);
-                if (b.is_set_value(p)) {
-                    continue;
-                }
-                size_t count = 0;
-                board::value_t possible_val = 0;
-                for (board::value_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
-                    if (b.is_possible(p, v)) {
-                        ++count;
-                        possible_val = v;
-                    }
-                }
-                if (count == 1) {
-                    b.set_value(p, possible_val, t);
-                    return true;
+        for (const cell_idx_t p : UNIT_CELLS[BOX_UNIT_BEGIN + s]) {
+            if (b.is_set_value(p)) {
+                continue;
+            }
+            size_t count = 0;
+            board::value_t possible_val = 0;
+            for (board::value_t v = board::BEGIN_VALUE; v < board::END_VALUE; ++v) {
+                if (b.is_possible(p, v)) {
+                    ++count;
+                    possible_val = v;
                 }
             }
+            if (count == 1) {
+                b.set_value(p, possible_val, t);
+                return true;
+            }
         }
     }
     return false;
@@ -4,14 +4,17 @@
 #include <array>
 #include <bitset>
 #include <functional>
+#include <random>
 
 #include "engine/board.h"
+#include "engine/details/tables.h"
 
 namespace engine {
 namespace details {
 
 using is_poss_fn_t = std::function<bool(size_t,board::value_t)>;
 using is_set_fn_t = std::function<bool(size_t)>;
+using random_engine_t = std::minstd_rand;
 using random_indices_t = std::array<size_t, board::BOARD_SIZE>;
 
 struct guess_t final
@@ -27,10 +30,7 @@ struct guess_t final
 guess_t find_guess_cell(const is_set_fn_t& is_set_fn, const is_poss_fn_t& is_poss_fn,
                         random_indices_t& rand_idx);
 
-inline size_t grid_start_col(const size_t c) { return c - (c % board::GRID_SIZE); }
-inline size_t grid_start_row(const size_t r) { return r - (r % board::GRID_SIZE); }
-
-void init_random();
+random_engine_t& random_engine();
 
 inline bool is_unique_in_col(const board::grid_t& b, const size_t c, const board::value_t v)
 {
@@ -46,31 +46,30 @@ inline bool is_unique_in_row(const board::grid_t& b, const size_t r, const board
 
 inline bool is_unique_in_grid(const board::grid_t& b, const size_t row, const size_t col, const board::value_t v)
 {
-    const size_t start_col = grid_start_col(col);
-    const size_t start_row = grid_start_row(row);
+    const size_t box = CELL_BOX[row * board::COL_SIZE + col];
     size_t count = 0;
-    for (size_t r = start_row; r < start_row + board::GRID_SIZE; ++r) {
-        for (size_t c = start_col; c < start_col + board::GRID_SIZE; ++c) {
-            if (b[r][c] == v) {
-                ++count;
-            }
+    for (const cell_idx_t p : UNIT_CELLS[BOX_UNIT_BEGIN + box]) {
+        if (b[CELL_ROW[p]][CELL_COL[p]] == v) {
+            ++count;
         }
     }
     return (count == 1);
 }
 
-inline size_t col_by_position(const size_t p) { return (p % board::COL_SIZE); }
-inline size_t row_by_position(const size_t p) { return (p / board::ROW_SIZE); }
+inline size_t col_by_position(const size_t p) { return CELL_COL[p]; }
+inline size_t row_by_position(const size_t p) { return CELL_ROW[p]; }
 inline size_t to_position(const size_t r, const size_t c) { return (r * board::ROW_SIZE + c); }
 
+void seed_random(const random_engine_t::result_type seed);
+
 template<typename TArray>
 void shaffle_array(TArray& array)
 {
-    init_random();
+    random_engine_t& engine = random_engine();
 
     for (size_t i = 0; i < array.size(); ++i) {
         const size_t tail = array.size() - i;
-        const size_t tail_idx = std::rand() % tail + i;
+        const size_t tail_idx = engine() % tail + i;
 
         std::swap(array[i], array[tail_idx]);
     }
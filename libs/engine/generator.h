@@ -1,11 +1,21 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <memory>
+#include <memory_resource>
 #include <string>
 
+#include "engine/bitboard_solver.h"
 #include "engine/board.h"
+#include "engine/budget.h"
 
 namespace engine {
+namespace details {
+
+class checker;
+
+} // namespace details
 
 class generator final
 {
@@ -24,13 +34,51 @@ public:
         INVALID
     };
 
-    generator();
+    static constexpr size_t DIFFICULT_COUNT = static_cast<size_t>(difficult::INVALID);
+
+    // Where generate() spends its time. Counters are kept per thread and summed by total_stats().
+    struct stats final
+    {
+        using duration_t = std::chrono::steady_clock::duration;
+
+        size_t calls = 0;
+
+        // Filling the solved grid, the generate_grid() step.
+        duration_t grid_time = duration_t::zero();
+
+        // Uniqueness checks, one per clue removal tried.
+        size_t solutions_calls = 0;
+        duration_t solutions_time = duration_t::zero();
+        size_t removals_accepted = 0;
+        size_t removals_rejected = 0;
+
+        duration_t rating_time = duration_t::zero();
+
+        // Finished puzzles per difficult level.
+        std::array<size_t, DIFFICULT_COUNT> difficulties = {};
+
+        // Calls per puzzle of level d, what a caller retrying for d pays on average; zero if none.
+        double attempts(const difficult d) const;
+
+        stats& operator+=(const stats& other);
+    };
+
+    // The checker rating the result allocates from p_mr.
+    explicit generator(std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+    generator(generator&& other) noexcept;
+    ~generator();
+
+    generator& operator=(generator&& other) noexcept;
 
     difficult difficulty() const { return m_dif; }
 
     std::string difficulty_str() const { return difficult_to_str(difficulty()); }
 
     board::grid_t generate();
+    search_result generate(board::grid_t& g, budget& b);
+
+    // The last generate() call of this generator.
+    const stats& last_stats() const { return m_stats; }
 
     size_t solutions_count() const { return m_solutions_count; }
 
@@ -38,16 +86,36 @@ public:
 
     static board::grid_t generate_grid();
 
+    // Every generate() call of the process, the running threads included.
+    static stats total_stats();
+    static void reset_total_stats();
+
 private:
+    // Destroys the checker and returns its memory to the resource it came from.
+    struct checker_deleter final
+    {
+        void operator()(details::checker* p_checker) const;
+
+        std::pmr::memory_resource* p_resource;
+    };
+
+private:
+    search_result generate_puzzle(board::grid_t& g, budget& b);
+
     void init();
 
     size_t random_pos(size_t p) const { return m_rand_board_idx[p]; }
 
 private:
+    // Uniqueness of every removal is checked on the bitboard, the checker rates the result.
+    bitboard_solver m_counter;
+    std::unique_ptr<details::checker, checker_deleter> m_p_checker;
     random_indices_t m_rand_board_idx;
 
     difficult m_dif = difficult::INVALID;
     size_t m_solutions_count = 0;
+
+    stats m_stats;
 };
 
 } // namespace engine
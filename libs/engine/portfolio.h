@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/budget.h"
+#include "engine/restart_policy.h"
+#include "engine/solver.h"
+
+namespace engine {
+
+class portfolio final
+{
+public:
+    using grid_t = board::grid_t;
+
+    struct config
+    {
+        solver::probing probing = solver::probing::NONE;
+        restart_policy restart;
+        unsigned seed = 0;
+    };
+
+    using configs_t = std::vector<config>;
+
+    static constexpr size_t INVALID_WINNER = static_cast<size_t>(-1);
+
+public:
+    explicit portfolio(std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+    explicit portfolio(configs_t configs, std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+
+    const configs_t& configs() const { return m_configs; }
+
+    // The solution of the last solve(), an empty grid unless it succeeded.
+    grid_t get_grid() const { return m_grid; }
+
+    bool solve(const grid_t& g);
+    // Every member gets an even share of the nodes left in b (budget::share()), and raising the
+    // cancel flag of b stops all of them.
+    search_result solve(const grid_t& g, const budget& b);
+
+    // Index of the configuration that finished first.
+    size_t winner() const { return m_winner; }
+
+    static configs_t default_configs(const size_t count);
+
+private:
+    configs_t m_configs;
+    std::pmr::memory_resource* m_p_resource;
+
+    grid_t m_grid;
+    size_t m_winner = INVALID_WINNER;
+};
+
+} // namespace engine
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace engine {
+
+class restart_policy final
+{
+public:
+    enum class schedule
+    {
+        NONE,
+        LUBY,
+        GEOMETRIC
+    };
+
+    static constexpr size_t DEFAULT_BASE = 64;
+
+public:
+    restart_policy() = default;
+
+    explicit restart_policy(const schedule s, const size_t base = DEFAULT_BASE, const bool keep_learned = true)
+        : m_schedule(s)
+        , m_base(std::max<size_t>(base, 1))
+        , m_is_keep_learned(keep_learned)
+    {
+        reset();
+    }
+
+    bool is_enabled() const { return (m_schedule != schedule::NONE); }
+
+    bool is_keep_learned() const { return m_is_keep_learned; }
+
+    // Backtracks allowed before the next restart.
+    size_t limit() const { return m_limit; }
+
+    void next()
+    {
+        ++m_restarts;
+        if (m_schedule == schedule::LUBY) {
+            m_limit = m_base * luby(m_restarts + 1);
+        } else if (m_schedule == schedule::GEOMETRIC) {
+            m_limit += std::max<size_t>(m_limit / 2, 1);
+        }
+    }
+
+    void reset()
+    {
+        m_restarts = 0;
+        m_limit = (m_schedule == schedule::LUBY) ? m_base * luby(1) : m_base;
+    }
+
+    size_t restarts() const { return m_restarts; }
+
+    // Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ... for i >= 1.
+    static size_t luby(size_t i)
+    {
+        size_t k = 1;
+        while (true) {
+            const size_t full = (size_t(1) << k) - 1;
+            if (i == full) {
+                return (size_t(1) << (k - 1));
+            }
+            if (i < full) {
+                i -= (size_t(1) << (k - 1)) - 1;
+                k = 1;
+            } else {
+                ++k;
+            }
+        }
+    }
+
+private:
+    schedule m_schedule = schedule::NONE;
+    size_t m_base = DEFAULT_BASE;
+    bool m_is_keep_learned = true;
+
+    size_t m_restarts = 0;
+    size_t m_limit = DEFAULT_BASE;
+};
+
+} // namespace engine
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+
+#include "engine/board.h"
+#include "engine/canonical.h"
+#include "engine/generator.h"
+
+namespace engine {
+
+// Bounded LRU cache of solved puzzles keyed by the canonical form, so a puzzle seen before under
+// another relabeling, transposition or line order is answered without solving it again. Entries are
+// split into shards with a lock each; p_mr must be thread safe when the cache is shared.
+class solution_cache final
+{
+public:
+    using grid_t = board::grid_t;
+    using difficult = generator::difficult;
+
+    struct result
+    {
+        grid_t solution = {};
+        size_t solutions_count = 0;
+        difficult difficulty = difficult::INVALID;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    static constexpr size_t SHARD_BITS = 4;
+    static constexpr size_t SHARDS_COUNT = size_t(1) << SHARD_BITS;
+
+public:
+    explicit solution_cache(const size_t capacity = DEFAULT_CAPACITY,
+                            std::pmr::memory_resource* p_mr = std::pmr::get_default_resource());
+    ~solution_cache();
+
+    solution_cache(const solution_cache&) = delete;
+    solution_cache& operator=(const solution_cache&) = delete;
+
+    // Rounded up to a multiple of SHARDS_COUNT, zero disables the cache.
+    size_t capacity() const { return m_shard_capacity * SHARDS_COUNT; }
+
+    void clear();
+
+    // The solution is mapped back to the layout of g.
+    bool find(const grid_t& g, result& r);
+
+    size_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+
+    size_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+    size_t size() const;
+
+    // Served from the cache, otherwise solved, counted (up to two) and rated, then stored.
+    result solve(const grid_t& g);
+
+    void store(const grid_t& g, const result& r);
+
+private:
+    struct shard;
+
+private:
+    bool find(const canonical_form& f, result& r);
+
+    shard& shard_of(const board::hash_t h) const;
+
+    void store(const canonical_form& f, const result& r);
+
+private:
+    std::array<std::unique_ptr<shard>, SHARDS_COUNT> m_shards;
+    size_t m_shard_capacity;
+
+    std::atomic<size_t> m_hits{0};
+    std::atomic<size_t> m_misses{0};
+};
+
+} // namespace engine
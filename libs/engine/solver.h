@@ -1,12 +1,19 @@
 #pragma once
 
 #include <array>
+#include <utility>
 
 #include "engine/board.h"
+#include "engine/budget.h"
+#include "engine/restart_policy.h"
+#include "engine/details/nogood_store.h"
+#include "engine/details/techniques.h"
 
 namespace engine {
 
-class solver final
+// TTechniques is a details::technique_list run to a fixpoint before every guess.
+template<typename TTechniques>
+class basic_solver final
 {
 private:
     using random_indices_t = std::array<size_t, board::BOARD_SIZE>;
@@ -15,33 +22,111 @@ public:
     using grid_t = board::grid_t;
     using value_t = board::value_t;
 
-    solver();
-    explicit solver(grid_t board);
+    enum class probing
+    {
+        NONE,
+        GUESS_CELL,
+        BIVALUE_CELLS
+    };
+
+    basic_solver();
+    explicit basic_solver(grid_t board);
 
     grid_t get_grid() const { return m_solver_board.grid(); }
     board get_board() const { return m_solver_board; }
 
+    size_t nogood_capacity() const { return m_nogoods.capacity(); }
+
+    // Nogoods learned by the last solve.
+    size_t nogoods_count() const { return m_nogoods.size(); }
+
+    probing probing_mode() const { return m_probing; }
+
+    const restart_policy& restart_mode() const { return m_restart; }
+
+    // Reusable context: loads a new grid without rebuilding the solver.
+    void reset(grid_t grid) { m_solver_board.reset(std::move(grid)); }
+
+    // Nogoods learned from failed guesses, zero (the default) disables learning.
+    void set_nogood_capacity(const size_t capacity) { m_nogoods.set_capacity(capacity); }
+
+    void set_probing(const probing p) { m_probing = p; }
+
+    void set_restart_policy(const restart_policy& p) { m_restart = p; }
+
     bool solve();
     bool solve(grid_t grid);
 
+    search_result solve(budget& b);
+    search_result solve(grid_t grid, budget& b);
+
     static bool is_impossible(const board& b);
 
     static bool is_solve_single_tag(const board::tag_t t) { return (t % 2 == 1); }
 
     static bool can_solve(const grid_t& g);
+    static search_result can_solve(const grid_t& g, budget& b);
 
     static bool is_solved(const grid_t& g);
     static bool is_solved(const board& brd);
 
 private:
+    enum class probe_result
+    {
+        NONE,
+        REDUCED,
+        SOLVED,
+        FAILED
+    };
+
+private:
+    bool is_budget_exceeded() const { return (m_p_budget != nullptr) && m_p_budget->is_exceeded(); }
+
+    void learn_conflict();
+
+    // Per-thread context behind the static helpers.
+    static basic_solver& local();
+
+    probe_result probe(const size_t guess_pos, const board::tag_t tag);
+    probe_result probe_cell(const size_t p, const board::tag_t tag);
+
+    // Runs the techniques and the nogoods to a fixpoint, false on a contradiction.
+    bool propagate(const board::tag_t tag);
+
+    bool search();
+
     bool solve(const board::tag_t tag);
 
-    static bool solve_single(board& b, const board::tag_t t);
+    bool spend_node() { return (m_p_budget == nullptr) || m_p_budget->spend(); }
+
+    static bool solve_single(board& b, const board::tag_t t)
+    {
+        return details::pipeline<TTechniques>::apply(b, t);
+    }
 
 private:
     board m_solver_board;
     mutable random_indices_t m_rand_board_idx;
+    probing m_probing = probing::NONE;
+    budget* m_p_budget = nullptr;
+
+    restart_policy m_restart;
+    size_t m_backtracks = 0;
+    bool m_is_restarting = false;
+
+    details::nogood_store m_nogoods;
+    board m_learn_root;
+    std::array<details::nogood_store::literal, board::BOARD_SIZE> m_guesses;
+    size_t m_guesses_count = 0;
 };
 
+extern template class basic_solver<details::singles_techniques>;
+extern template class basic_solver<details::subsets_techniques>;
+extern template class basic_solver<details::templates_techniques>;
+
+using solver = basic_solver<details::singles_techniques>;
+using subsets_solver = basic_solver<details::subsets_techniques>;
+using templates_solver = basic_solver<details::templates_techniques>;
+
 } // namespace engine
 
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "engine/board.h"
+
+namespace engine {
+
+// 81-character lines, row by row, '0' or '.' for an empty cell. SSE2 builds check and convert
+// 16 cells at a time, 32 on CPUs with AVX2; other targets fall back to a scalar loop.
+class text final
+{
+public:
+    using grid_t = board::grid_t;
+
+    static constexpr size_t LINE_SIZE = board::BOARD_SIZE;
+
+    enum class error
+    {
+        NONE,
+        SHORT_LINE,
+        LONG_LINE,
+        BAD_CHAR
+    };
+
+    struct parse_result
+    {
+        error code = error::NONE;
+        // Offset of the offending character, or of the end of a short line.
+        size_t offset = 0;
+        // Lines parsed before the error by parse_lines().
+        size_t lines = 0;
+    };
+
+public:
+    // p_out receives LINE_SIZE characters, no terminator.
+    static void format(const grid_t& g, char* p_out, const char blank = '0');
+    static std::string format(const grid_t& g, const char blank = '0');
+
+    static parse_result parse(std::string_view line, grid_t& g);
+
+    // Newline separated lines, "\r\n" and empty lines accepted; grids are appended.
+    static parse_result parse_lines(std::string_view buf, std::vector<grid_t>& grids);
+
+    static std::string error_to_str(const error e);
+};
+
+} // namespace engine
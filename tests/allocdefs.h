@@ -0,0 +1,74 @@
+#ifndef TESTING_ALLOCDEFS_H
+#define TESTING_ALLOCDEFS_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+// Replaces the global operator new/delete to count heap allocations. The replacements are not
+// inline, so the header has to be included by a single translation unit of a test target.
+
+namespace tests {
+
+class alloc_counter final
+{
+public:
+    static void add() { counter().fetch_add(1, std::memory_order_relaxed); }
+
+    static size_t count() { return counter().load(std::memory_order_relaxed); }
+
+    static std::atomic<size_t>& counter()
+    {
+        static std::atomic<size_t> value(0);
+        return value;
+    }
+};
+
+// Counts the allocations made during its lifetime.
+class alloc_scope final
+{
+public:
+    alloc_scope()
+        : m_begin(alloc_counter::count())
+    {}
+
+    size_t allocations() const { return alloc_counter::count() - m_begin; }
+
+private:
+    const size_t m_begin;
+};
+
+} // namespace tests
+
+void* operator new(std::size_t size)
+{
+    tests::alloc_counter::add();
+    if (void* p = std::malloc((size != 0) ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    tests::alloc_counter::add();
+    return std::malloc((size != 0) ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#endif // TESTING_ALLOCDEFS_H
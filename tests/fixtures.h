@@ -0,0 +1,78 @@
+#ifndef TESTING_FIXTURES_H
+#define TESTING_FIXTURES_H
+
+#include <sstream>
+#include <string>
+
+#include "engine/board.h"
+
+// Grids shared by several test targets.
+
+namespace tests {
+
+// Singles stall on it, so it takes a few guesses; one solution.
+inline const engine::board::grid_t guess_td = {
+    {{0, 8, 0, 0, 0, 0, 0, 2, 0},
+     {5, 9, 0, 0, 3, 0, 0, 4, 1},
+     {4, 0, 0, 9, 0, 5, 0, 0, 6},
+     {0, 0, 0, 2, 7, 3, 0, 0, 0},
+     {0, 0, 0, 8, 0, 9, 0, 0, 0},
+     {9, 0, 0, 0, 1, 0, 0, 0, 2},
+     {0, 7, 0, 0, 0, 0, 0, 1, 0},
+     {0, 3, 9, 0, 0, 0, 2, 5, 0},
+     {2, 0, 0, 0, 0, 0, 0, 0, 4}}
+};
+
+inline const engine::board::grid_t guess_etalon = {
+    {{7, 8, 3, 4, 6, 1, 5, 2, 9},
+     {5, 9, 6, 7, 3, 2, 8, 4, 1},
+     {4, 2, 1, 9, 8, 5, 7, 3, 6},
+     {1, 6, 8, 2, 7, 3, 4, 9, 5},
+     {3, 4, 2, 8, 5, 9, 1, 6, 7},
+     {9, 5, 7, 6, 1, 4, 3, 8, 2},
+     {8, 7, 4, 5, 2, 6, 9, 1, 3},
+     {6, 3, 9, 1, 4, 7, 2, 5, 8},
+     {2, 1, 5, 3, 9, 8, 6, 7, 4}}
+};
+
+// One solution; singles and pairs stall on it, so it takes guesses or template overlays.
+inline const engine::board::grid_t very_hard_td = {
+    {{0, 6, 0, 7, 2, 0, 0, 0, 0},
+     {0, 2, 0, 0, 9, 0, 0, 4, 7},
+     {0, 0, 0, 0, 0, 3, 0, 0, 0},
+     {0, 0, 1, 5, 0, 2, 0, 0, 9},
+     {8, 5, 0, 0, 0, 0, 0, 6, 2},
+     {6, 0, 0, 4, 0, 8, 3, 0, 0},
+     {0, 0, 0, 3, 0, 0, 0, 0, 0},
+     {7, 1, 0, 0, 5, 0, 0, 9, 0},
+     {0, 0, 0, 0, 8, 9, 0, 1, 0}}
+};
+
+// very_hard_td without three givens, for counting many solutions.
+inline const engine::board::grid_t very_hard_multi_td = {
+    {{0, 6, 0, 7, 2, 0, 0, 0, 0},
+     {0, 2, 0, 0, 9, 0, 0, 4, 7},
+     {0, 0, 0, 0, 0, 3, 0, 0, 0},
+     {0, 0, 1, 5, 0, 0, 0, 0, 9},
+     {8, 5, 0, 0, 0, 0, 0, 6, 2},
+     {6, 0, 0, 4, 0, 0, 3, 0, 0},
+     {0, 0, 0, 3, 0, 0, 0, 0, 0},
+     {7, 1, 0, 0, 5, 0, 0, 9, 0},
+     {0, 0, 0, 0, 8, 0, 0, 1, 0}}
+};
+
+inline std::string print(const engine::board::grid_t& board)
+{
+    std::stringstream ss;
+    for (size_t i = 0; i < board.size(); ++i) {
+        for (size_t j = 0; j < board[i].size(); ++j) {
+            ss << (size_t)board[i][j] << " ";
+        }
+        ss << std::endl;
+    }
+    return ss.str();
+}
+
+} // namespace tests
+
+#endif // TESTING_FIXTURES_H
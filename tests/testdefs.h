@@ -25,13 +25,18 @@
 #ifndef TESTING_TESTDEFS_H
 #define TESTING_TESTDEFS_H
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <numeric>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -39,6 +44,13 @@
 #include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace tests {
 
 class timer final
@@ -87,6 +99,321 @@ private:
     double m_time_ms = 0.0;
 };
 
+// Latency histogram in nanoseconds with HDR-style log-linear buckets: exact below 128 ns, then 64
+// buckets per power of two, so a recorded value is off by less than 1/64. Recording is an index
+// computation and an increment; histograms of several threads are merged with +=.
+class histogram final
+{
+public:
+    static constexpr size_t SUB_BUCKETS = 64;
+    static constexpr size_t BUCKETS_COUNT = 2 * SUB_BUCKETS + (64 - 7) * SUB_BUCKETS;
+
+    // Records the lifetime of the scope.
+    class scope final
+    {
+    public:
+        explicit scope(histogram& h)
+            : m_hist(h)
+            , m_start(std::chrono::steady_clock::now())
+        {}
+
+        ~scope() { m_hist.record(std::chrono::steady_clock::now() - m_start); }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        histogram& m_hist;
+        const std::chrono::steady_clock::time_point m_start;
+    };
+
+public:
+    histogram()
+        : m_counts(BUCKETS_COUNT, 0)
+    {}
+
+    void record(const uint64_t ns)
+    {
+        ++m_counts[index(ns)];
+        ++m_count;
+        m_sum += ns;
+        m_min = std::min(m_min, ns);
+        m_max = std::max(m_max, ns);
+    }
+
+    template<typename TRep, typename TPeriod>
+    void record(const std::chrono::duration<TRep, TPeriod> d)
+    {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t max() const { return m_max; }
+    uint64_t min() const { return (m_count != 0) ? m_min : 0; }
+    double mean() const { return (m_count != 0) ? static_cast<double>(m_sum) / m_count : 0.0; }
+
+    // Highest value of the bucket holding the p-th percentile, p in [0, 100]; zero when empty.
+    uint64_t percentile(const double p) const
+    {
+        if (m_count == 0) {
+            return 0;
+        }
+        const double rank = std::min(std::max(p, 0.0), 100.0) / 100.0 * m_count;
+        const uint64_t target = std::max<uint64_t>(static_cast<uint64_t>(rank + 0.5), 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            seen += m_counts[i];
+            if (seen >= target) {
+                return std::min(highest_value(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    void reset()
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+        m_sum = 0;
+        m_min = UINT64_MAX;
+        m_max = 0;
+    }
+
+    histogram& operator+=(const histogram& other)
+    {
+        for (size_t i = 0; i < m_counts.size(); ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        return *this;
+    }
+
+    // Microseconds, the unit of puzzle latencies.
+    std::string report() const
+    {
+        std::stringstream ss;
+        ss << "count: " << m_count << ", mean: " << mean() / 1000.0 << " us";
+        for (const double p : {50.0, 90.0, 99.0, 99.9}) {
+            ss << ", p" << p << ": " << percentile(p) / 1000.0 << " us";
+        }
+        ss << ", max: " << m_max / 1000.0 << " us";
+        return ss.str();
+    }
+
+private:
+    static size_t msb(const uint64_t v)
+    {
+#if defined(__GNUC__)
+        return 63 - static_cast<size_t>(__builtin_clzll(v));
+#else
+        size_t bit = 0;
+        while ((v >> bit) > 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static size_t index(const uint64_t v)
+    {
+        if (v < 2 * SUB_BUCKETS) {
+            return static_cast<size_t>(v);
+        }
+        const size_t shift = msb(v) - 6;
+        return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + static_cast<size_t>((v >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t highest_value(const size_t i)
+    {
+        if (i < 2 * SUB_BUCKETS) {
+            return i;
+        }
+        const size_t shift = (i - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+        const uint64_t sub = (i - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_min = UINT64_MAX;
+    uint64_t m_max = 0;
+};
+
+// Hardware counters of the calling thread, user space only, read with perf_event_open around the
+// measured regions like timer. Counters the kernel refuses (no PMU in a VM, perf_event_paranoid,
+// seccomp) are reported as unavailable and read as zero. The test runner prints them per test
+// when TESTS_PERF_COUNTERS is set in the environment.
+class perf_counters final
+{
+public:
+    enum event
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        EVENTS_COUNT
+    };
+
+    using values_t = std::array<uint64_t, EVENTS_COUNT>;
+
+public:
+    perf_counters(bool run = false)
+    {
+        m_fds.fill(-1);
+#if defined(__linux__)
+        // The first event that opens leads the group, so all counters cover the same interval.
+        for (size_t e = 0; e < EVENTS_COUNT; ++e) {
+            m_fds[e] = open_event(static_cast<event>(e), m_leader);
+            if ((m_leader == -1) && (m_fds[e] != -1)) {
+                m_leader = m_fds[e];
+            }
+        }
+#endif
+        if (run) {
+            start();
+        }
+    }
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (const int fd : m_fds) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    bool is_available() const { return is_available(CYCLES) || is_available(INSTRUCTIONS); }
+    bool is_available(const event e) const { return (m_fds[e] != -1); }
+
+    void pause()
+    {
+        if (! is_start) {
+            return;
+        }
+#if defined(__linux__)
+        if (m_leader != -1) {
+            ::ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            // One read returns {nr, time_enabled, time_running, values in opening order}; the group
+            // is scheduled as a whole, so multiplexed counts share one scale.
+            uint64_t data[3 + EVENTS_COUNT] = {};
+            const ssize_t size = ::read(m_leader, data, sizeof(data));
+            if ((size >= static_cast<ssize_t>(3 * sizeof(uint64_t))) && (data[2] != 0)) {
+                const double scale = static_cast<double>(data[1]) / data[2];
+                size_t i = 0;
+                for (size_t e = 0; (e < EVENTS_COUNT) && (i < data[0]); ++e) {
+                    if (m_fds[e] != -1) {
+                        m_values[e] += static_cast<uint64_t>(static_cast<double>(data[3 + i]) * scale);
+                        ++i;
+                    }
+                }
+            }
+        }
+#endif
+        is_start = false;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (m_leader != -1) {
+            ::ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        is_start = true;
+    }
+
+    void stop()
+    {
+        pause();
+        m_values.fill(0);
+    }
+
+    const values_t& values()
+    {
+        if (is_start) {
+            pause();
+            start();
+        }
+        return m_values;
+    }
+
+    // Per item averages of the available counters, empty if there are none.
+    std::string report(const size_t items = 1)
+    {
+        const values_t& v = values();
+        std::stringstream ss;
+        for (size_t e = 0; e < EVENTS_COUNT; ++e) {
+            if (is_available(static_cast<event>(e))) {
+                ss << (ss.tellp() > 0 ? ", " : "") << event_name(static_cast<event>(e)) << ": "
+                   << static_cast<double>(v[e]) / std::max<size_t>(items, 1);
+            }
+        }
+        if (is_available(CYCLES) && is_available(INSTRUCTIONS) && (v[CYCLES] != 0)) {
+            ss << ", ipc: " << static_cast<double>(v[INSTRUCTIONS]) / v[CYCLES];
+        }
+        return ss.str();
+    }
+
+    static const char* event_name(const event e)
+    {
+        static const char* const names[EVENTS_COUNT] = {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                                        "branch_misses"};
+        return names[e];
+    }
+
+    static bool is_enabled()
+    {
+        static const bool enabled = (std::getenv("TESTS_PERF_COUNTERS") != nullptr);
+        return enabled;
+    }
+
+private:
+#if defined(__linux__)
+    // Members follow the leader's enable state; only the leader starts disabled.
+    static int open_event(const event e, const int leader)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = (leader == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        if ((e == L1D_MISSES) || (e == LLC_MISSES)) {
+            attr.type = PERF_TYPE_HW_CACHE;
+            const uint64_t cache = (e == L1D_MISSES) ? PERF_COUNT_HW_CACHE_L1D : PERF_COUNT_HW_CACHE_LL;
+            attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        } else {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = (e == CYCLES) ? PERF_COUNT_HW_CPU_CYCLES
+                        : (e == INSTRUCTIONS) ? PERF_COUNT_HW_INSTRUCTIONS : PERF_COUNT_HW_BRANCH_MISSES;
+        }
+        const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        return (fd < 0) ? -1 : static_cast<int>(fd);
+    }
+#endif
+
+private:
+    bool is_start = false;
+    int m_leader = -1;
+    std::array<int, EVENTS_COUNT> m_fds;
+    values_t m_values = {};
+};
+
 namespace details {
 
 template<size_t N, typename TTuple, template<typename> typename TInsertType, template<typename> class TPtr, typename TType>
@@ -183,13 +510,23 @@ public:
                 tester::begin_test();
                 std::cout << "[RUN       ] " << m_case_name << "." << test_name << std::endl;
 
+                std::unique_ptr<perf_counters> p_perf;
+                if (perf_counters::is_enabled()) {
+                    p_perf = std::make_unique<perf_counters>(true);
+                }
                 timer test_sw(true);
                 p_suite->test_body();
                 const double test_ms = test_sw.value_ms();
+                if (p_perf) {
+                    p_perf->pause();
+                }
 
                 failed_count += (tester::end_test() != 0) ? 1 : 0;
                 const std::string res_str = (tester::end_test() == 0) ? "[       OK ] " : "[   FAILED ] ";
                 std::cout << res_str << m_case_name << "." << test_name << " (" << test_ms << " ms)" << std::endl;
+                if (p_perf && p_perf->is_available()) {
+                    std::cout << "[   PERF   ] " << p_perf->report() << std::endl;
+                }
             }
 
             return failed_count;
@@ -0,0 +1,83 @@
+#include <memory_resource>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/budget.h"
+#include "engine/generator.h"
+#include "engine/solver.h"
+#include "engine/details/checker.h"
+
+#include "allocdefs.h"
+#include "fixtures.h"
+#include "testdefs.h"
+
+namespace {
+
+constexpr size_t WARM_UP_COUNT = 4;
+constexpr size_t MEASURE_COUNT = 16;
+
+// Runs fn until the caches are warm, then returns the allocations of the measured runs.
+template<typename TFn>
+size_t steady_allocations(TFn fn)
+{
+    for (size_t i = 0; i < WARM_UP_COUNT; ++i) {
+        fn();
+    }
+
+    tests::alloc_scope scope;
+    for (size_t i = 0; i < MEASURE_COUNT; ++i) {
+        fn();
+    }
+    return scope.allocations();
+}
+
+} // <anonymous> namespace
+
+TEST(sudoku_alloc, solver_solve)
+{
+    engine::solver sl;
+    const size_t allocs = steady_allocations([&sl]() -> void { sl.solve(tests::very_hard_td); });
+    EXPECTED(allocs == 0) << "allocations: " << allocs << std::endl;
+}
+
+TEST(sudoku_alloc, checker_calc_solutions)
+{
+    const engine::board::grid_t empty = engine::board().grid();
+    const size_t allocs = steady_allocations([&empty]() -> void {
+        engine::details::checker::calc_solutions(tests::very_hard_td);
+        engine::details::checker::calc_solutions(empty, 16);
+    });
+    EXPECTED(allocs == 0) << "allocations: " << allocs << std::endl;
+}
+
+TEST(sudoku_alloc, checker_calc_difficulty)
+{
+    const size_t allocs = steady_allocations([]() -> void {
+        engine::details::checker::calc_difficulty(tests::very_hard_td);
+    });
+    EXPECTED(allocs == 0) << "allocations: " << allocs << std::endl;
+}
+
+TEST(sudoku_alloc, generator_generate)
+{
+    engine::generator gen;
+    const size_t allocs = steady_allocations([&gen]() -> void { gen.generate(); });
+    EXPECTED(allocs == 0) << "allocations: " << allocs << std::endl;
+}
+
+TEST(sudoku_alloc, generator_resource)
+{
+    // Everything a generator allocates on construction comes from its resource.
+    std::vector<char> buffer(64 * 1024 * 1024);
+    std::pmr::monotonic_buffer_resource mr(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    { engine::generator warm_up(&mr); }
+
+    tests::alloc_scope scope;
+    engine::generator gen(&mr);
+    EXPECTED(scope.allocations() == 0) << "allocations: " << scope.allocations() << std::endl;
+}
+
+int main()
+{
+    return RUN_TESTS();
+}
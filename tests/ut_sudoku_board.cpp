@@ -1,12 +1,17 @@
 #include <bitset>
-#include <sstream>
 #include <string>
 
 #include "engine/board.h"
+#include "engine/board_view.h"
+#include "engine/counters.h"
+#include "engine/solver.h"
 #include "engine/details/utils.h"
 
+#include "fixtures.h"
 #include "testdefs.h"
 
+using tests::print;
+
 namespace {
 
 const engine::board::grid_t td = {
@@ -26,18 +31,6 @@ bool is_possible(const engine::board& b, const size_t r, const size_t c, const e
     return b.is_possible(engine::details::to_position(r, c), v);
 }
 
-std::string print(const engine::board::grid_t& board)
-{
-    std::stringstream ss;
-    for (size_t i = 0; i < board.size(); ++i) {
-        for (size_t j = 0; j < board[i].size(); ++j) {
-            ss << (size_t)board[i][j] << " ";
-        }
-        ss << std::endl;
-    }
-    return ss.str();
-}
-
 bool set_value(engine::board& b, const size_t r, const size_t c, const engine::board::value_t& v)
 {
     return b.set_value(engine::details::to_position(r, c), v, engine::board::BEGIN_TAG);
@@ -149,6 +142,157 @@ TEST(sudoku_board, rollback)
         << "Test result: " << std::endl << print(sb.grid()) << std::endl;
 }
 
+TEST(sudoku_board, rollback_eliminations)
+{
+    engine::board sb(td);
+    EXPECTED(set_value(sb, 8, 0, 8));
+    EXPECTED(sb.set_impossible(engine::details::to_position(8, 1), 4, engine::board::BEGIN_TAG + 1));
+    EXPECTED(! is_possible(sb, 8, 1, 4));
+
+    sb.rollback_to_tag(engine::board::BEGIN_TAG);
+    EXPECTED(is_possible(sb, 8, 1, 4));
+    EXPECTED(! is_possible(sb, 8, 1, 8));
+    EXPECTED(engine::board::max_tag(sb) == engine::board::BEGIN_TAG);
+}
+
+TEST(sudoku_board, hash)
+{
+    engine::board sb(td);
+    const engine::board::hash_t init_hash = sb.hash();
+    EXPECTED(init_hash != engine::board().hash());
+
+    EXPECTED(set_value(sb, 0, 1, 1));
+    EXPECTED(sb.hash() != init_hash);
+    EXPECTED(sb.set_value(engine::details::to_position(0, 4), 7, engine::board::BEGIN_TAG + 1));
+
+    // The hash depends on the placed values only, not on the order of placement.
+    engine::board other(td);
+    EXPECTED(other.set_value(engine::details::to_position(0, 4), 7, engine::board::BEGIN_TAG));
+    EXPECTED(other.set_value(engine::details::to_position(0, 1), 1, engine::board::BEGIN_TAG + 1));
+    EXPECTED(sb.hash() == other.hash());
+    EXPECTED(engine::board(sb.grid()).hash() == sb.hash());
+
+    sb.rollback_to_tag(engine::board::BEGIN_TAG);
+    EXPECTED(engine::board(sb.grid()).hash() == sb.hash());
+    sb.rollback_to_tag(engine::board::DEFAULT_TAG);
+    EXPECTED(sb.hash() == init_hash);
+}
+
+TEST(sudoku_board, board_view_storages)
+{
+    std::string text = "306508400520000000087000031003010080900863005050090600130000250000000074005206300";
+    engine::text_board_view text_view(engine::text_storage(text.data(), '.'));
+    EXPECTED(text_view.grid() == td) << print(text_view.grid()) << std::endl;
+    text_view.set_value(1, 1);
+    text_view.set_value(0, 0);
+    EXPECTED(text.substr(0, 3) == ".16") << text.substr(0, 3) << std::endl;
+    EXPECTED(! text_view.is_set_value(0) && text_view.value(1) == 1);
+
+    std::array<uint8_t, engine::nibble_storage::SIZE> bytes = {};
+    engine::nibble_board_view nibble_view((engine::nibble_storage(bytes.data())));
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        nibble_view.set_value(p, td[p / engine::board::COL_SIZE][p % engine::board::COL_SIZE]);
+    }
+    EXPECTED(bytes[0] == 0x03 && bytes[1] == 0x56);
+    EXPECTED(nibble_view.grid() == td) << print(nibble_view.grid()) << std::endl;
+
+    engine::board loaded;
+    loaded.reset_from(nibble_view.storage());
+    EXPECTED(loaded.grid() == td) << print(loaded.grid()) << std::endl;
+    EXPECTED(loaded.hash() == engine::board(td).hash());
+    EXPECTED(! is_possible(loaded, 8, 0, 1) && is_possible(loaded, 8, 0, 8));
+
+    // Read-only storages over const buffers.
+    const std::string const_text = text;
+    const engine::const_text_board_view const_text_view(engine::const_text_storage(const_text.data(), '.'));
+    EXPECTED(const_text_view.value(0) == 0 && const_text_view.value(1) == 1);
+    const engine::board::grid_t& const_grid = td;
+    const engine::const_board_view const_view((engine::const_grid_storage(const_grid)));
+    EXPECTED(&const_view.grid() == &td);
+    loaded.reset_from(const_view.storage());
+    EXPECTED(loaded.grid() == td) << print(loaded.grid()) << std::endl;
+
+    // A grid inside a wider matrix, then the same cells read column by column.
+    constexpr size_t stride = engine::board::COL_SIZE + 3;
+    std::array<engine::board::value_t, engine::board::ROW_SIZE * stride> matrix = {};
+    engine::strided_board_view strided_view(engine::strided_storage(matrix.data(), stride));
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        strided_view.set_value(p, td[p / engine::board::COL_SIZE][p % engine::board::COL_SIZE]);
+    }
+    EXPECTED(strided_view.grid() == td);
+    EXPECTED(matrix[stride] == 5);
+
+    const engine::strided_board_view transposed(engine::strided_storage(matrix.data(), 1, stride));
+    for (size_t r = 0; r < engine::board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < engine::board::COL_SIZE; ++c) {
+            EXPECTED(transposed.grid()[r][c] == td[c][r]);
+        }
+    }
+}
+
+TEST(sudoku_board, validate)
+{
+    EXPECTED(engine::board::is_valid(td));
+    EXPECTED(engine::board::is_valid(engine::board().grid()));
+
+    // The 3 repeats the one of row 0 and the one of column 1.
+    engine::board::grid_t g = td;
+    g[0][1] = 3;
+    const engine::board::conflicts_t conflicts = engine::board::validate(g);
+    EXPECTED(! engine::board::is_valid(g));
+    EXPECTED(conflicts.count() == 3) << conflicts << std::endl;
+    EXPECTED(conflicts.test(engine::details::to_position(0, 0)));
+    EXPECTED(conflicts.test(engine::details::to_position(0, 1)));
+    EXPECTED(conflicts.test(engine::details::to_position(6, 1)));
+
+    // Same box, different row and column.
+    g = td;
+    g[1][2] = 8;
+    EXPECTED(engine::board::validate(g).count() == 2) << engine::board::validate(g) << std::endl;
+
+    g = td;
+    g[8][8] = 12;
+    EXPECTED(engine::board::validate(g).count() == 1);
+    EXPECTED(engine::board::validate(g).test(engine::board::BOARD_SIZE - 1));
+
+    // Loading leaves the values out of range unmarked instead of indexing the tables with them.
+    g[0][1] = -16;
+    const engine::board loaded(g);
+    EXPECTED(! loaded.is_set_value(1) && ! loaded.is_set_value(engine::board::BOARD_SIZE - 1));
+    g[0][1] = 0;
+    g[8][8] = 0;
+    EXPECTED(loaded.hash() == engine::board(g).hash());
+    EXPECTED(engine::board::validate(loaded.grid()).count() == 2) << engine::board::validate(loaded.grid()) << std::endl;
+}
+
+TEST(sudoku_board, counters)
+{
+    engine::counters::reset();
+    engine::board b(td);
+    b.set_value(1, 1, engine::board::BEGIN_TAG);
+    b.set_impossible(2, 2, engine::board::BEGIN_TAG);
+    b.rollback_to_tag(engine::board::DEFAULT_TAG);
+
+    const engine::counters& c = engine::counters::local();
+    if (! engine::counters::IS_ENABLED) {
+        EXPECTED(c.set_values == 0 && c.set_impossibles == 0 && c.rollbacks == 0 && c.undone == 0);
+        return;
+    }
+    EXPECTED(c.set_values == 1 && c.set_impossibles == 1 && c.rollbacks == 1) << c.to_json() << std::endl;
+    // The value, its eliminations in the cell and peers, and the explicit elimination.
+    EXPECTED(c.undone > 2) << c.to_json() << std::endl;
+
+    engine::counters::reset();
+    EXPECTED(engine::solver::can_solve(tests::very_hard_td));
+    EXPECTED(c.guesses > 0 && c.max_depth > 1) << c.to_json() << std::endl;
+    EXPECTED(c.technique_hits[static_cast<size_t>(engine::technique_id::SINGLE_CELL)] > 0) << c.to_json() << std::endl;
+
+    engine::counters sum = c;
+    sum += c;
+    EXPECTED(sum.guesses == 2 * c.guesses && sum.max_depth == c.max_depth);
+    EXPECTED(c.to_json().find("\"SINGLE_CELL\":") != std::string::npos) << c.to_json() << std::endl;
+}
+
 int main()
 {
     return RUN_TESTS();
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/canonical.h"
+#include "engine/generator.h"
+#include "engine/solution_cache.h"
+#include "engine/solver.h"
+
+#include "fixtures.h"
+#include "testdefs.h"
+
+using tests::print;
+
+namespace {
+
+constexpr size_t TRANSFORMS_COUNT = 16;
+
+const engine::board::grid_t td = {
+    {{3, 0, 6, 5, 0, 8, 4, 0, 0},
+     {5, 2, 0, 0, 0, 0, 0, 0, 0},
+     {0, 8, 7, 0, 0, 0, 0, 3, 1},
+     {0, 0, 3, 0, 1, 0, 0, 8, 0},
+     {9, 0, 0, 8, 6, 3, 0, 0, 5},
+     {0, 5, 0, 0, 9, 0, 6, 0, 0},
+     {1, 3, 0, 0, 0, 0, 2, 5, 0},
+     {0, 0, 0, 0, 0, 0, 0, 7, 4},
+     {0, 0, 5, 2, 0, 6, 3, 0, 0}}
+};
+
+engine::transform::lines_t random_lines(std::mt19937& rng)
+{
+    std::array<uint8_t, engine::board::GRID_SIZE> triples = {0, 1, 2};
+    std::shuffle(triples.begin(), triples.end(), rng);
+
+    engine::transform::lines_t lines;
+    for (size_t k = 0; k < triples.size(); ++k) {
+        std::array<uint8_t, engine::board::GRID_SIZE> inner = {0, 1, 2};
+        std::shuffle(inner.begin(), inner.end(), rng);
+        for (size_t j = 0; j < inner.size(); ++j) {
+            lines[k * engine::board::GRID_SIZE + j] = triples[k] * engine::board::GRID_SIZE + inner[j];
+        }
+    }
+    return lines;
+}
+
+engine::transform random_transform(std::mt19937& rng)
+{
+    engine::transform t;
+    t.is_transposed = (rng() % 2 == 1);
+    t.rows = random_lines(rng);
+    t.cols = random_lines(rng);
+    std::shuffle(t.digits.begin() + 1, t.digits.end(), rng);
+    return t;
+}
+
+// Every given of the puzzle is kept by the solution.
+bool is_solution_of(const engine::board::grid_t& puzzle, const engine::board::grid_t& solution)
+{
+    for (size_t r = 0; r < engine::board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < engine::board::COL_SIZE; ++c) {
+            if ((puzzle[r][c] != 0) && (puzzle[r][c] != solution[r][c])) {
+                return false;
+            }
+        }
+    }
+    return engine::solver::is_solved(solution);
+}
+
+} // <anonymous> namespace
+
+TEST(sudoku_canonical, transform)
+{
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < TRANSFORMS_COUNT; ++i) {
+        const engine::transform t = random_transform(rng);
+        const engine::board::grid_t g = t.apply(td);
+        EXPECTED(t.revert(g) == td) << "Transformed grid:" << std::endl << print(g) << std::endl;
+        EXPECTED(engine::solver::can_solve(g));
+    }
+}
+
+TEST(sudoku_canonical, puzzle)
+{
+    std::mt19937 rng(2);
+    for (const engine::board::grid_t& puzzle : {td, tests::very_hard_td}) {
+        const engine::canonical_form etalon = engine::canonicalizer::calc(puzzle);
+        EXPECTED(etalon.trans.apply(puzzle) == etalon.grid);
+        EXPECTED(etalon.hash == engine::board(etalon.grid).hash());
+        EXPECTED(engine::canonicalizer::calc(etalon.grid).grid == etalon.grid);
+
+        for (size_t i = 0; i < TRANSFORMS_COUNT; ++i) {
+            const engine::board::grid_t g = random_transform(rng).apply(puzzle);
+            const engine::canonical_form f = engine::canonicalizer::calc(g);
+            EXPECTED(f.grid == etalon.grid)
+                << "Canonical grid:" << std::endl << print(f.grid) << std::endl
+                << "Etalon grid:" << std::endl << print(etalon.grid) << std::endl;
+            EXPECTED(f.hash == etalon.hash);
+            EXPECTED(f.trans.revert(f.grid) == g);
+        }
+    }
+}
+
+TEST(sudoku_canonical, solved_grid)
+{
+    std::mt19937 rng(3);
+    const engine::board::grid_t grid = engine::generator::generate_grid();
+    const engine::canonical_form etalon = engine::canonicalizer::calc(grid);
+
+    const engine::board::row_t first_row = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECTED(etalon.grid[0] == first_row) << "Canonical grid:" << std::endl << print(etalon.grid) << std::endl;
+    EXPECTED(engine::solver::is_solved(etalon.grid));
+
+    for (size_t i = 0; i < TRANSFORMS_COUNT; ++i) {
+        const engine::canonical_form f = engine::canonicalizer::calc(random_transform(rng).apply(grid));
+        EXPECTED(f.grid == etalon.grid);
+    }
+}
+
+TEST(sudoku_solution_cache, solve)
+{
+    std::mt19937 rng(4);
+    engine::solution_cache cache;
+
+    const engine::solution_cache::result etalon = cache.solve(tests::very_hard_td);
+    EXPECTED(cache.misses() == 1 && cache.hits() == 0);
+    EXPECTED(etalon.solutions_count == 1);
+    EXPECTED(etalon.difficulty == engine::generator::difficult::VERY_HARD);
+    EXPECTED(is_solution_of(tests::very_hard_td, etalon.solution));
+
+    for (size_t i = 0; i < TRANSFORMS_COUNT; ++i) {
+        const engine::board::grid_t g = random_transform(rng).apply(tests::very_hard_td);
+        const engine::solution_cache::result r = cache.solve(g);
+        EXPECTED(r.solutions_count == etalon.solutions_count);
+        EXPECTED(r.difficulty == etalon.difficulty);
+        EXPECTED(is_solution_of(g, r.solution)) << "Solution:" << std::endl << print(r.solution) << std::endl;
+    }
+    EXPECTED(cache.misses() == 1 && cache.hits() == TRANSFORMS_COUNT)
+        << "hits: " << cache.hits() << ", misses: " << cache.misses() << std::endl;
+    EXPECTED(cache.size() == 1);
+}
+
+TEST(sudoku_solution_cache, eviction)
+{
+    engine::solution_cache cache(engine::solution_cache::SHARDS_COUNT);
+    EXPECTED(cache.capacity() == engine::solution_cache::SHARDS_COUNT);
+
+    engine::generator gen;
+    std::vector<engine::board::grid_t> puzzles;
+    for (size_t i = 0; i < 4 * engine::solution_cache::SHARDS_COUNT; ++i) {
+        puzzles.push_back(gen.generate());
+        engine::solution_cache::result r;
+        r.solutions_count = gen.solutions_count();
+        r.difficulty = gen.difficulty();
+        cache.store(puzzles.back(), r);
+        EXPECTED(cache.size() <= cache.capacity()) << "size: " << cache.size() << std::endl;
+    }
+
+    // The latest store of a shard is never evicted.
+    engine::solution_cache::result r;
+    EXPECTED(cache.find(puzzles.back(), r));
+    EXPECTED(r.difficulty == gen.difficulty());
+
+    cache.clear();
+    EXPECTED(cache.size() == 0);
+    EXPECTED(! cache.find(puzzles.back(), r));
+
+    engine::solution_cache disabled(0);
+    disabled.store(puzzles.back(), r);
+    EXPECTED(disabled.size() == 0);
+}
+
+TEST(sudoku_solution_cache, concurrent)
+{
+    const size_t threads_count = 4;
+    engine::solution_cache cache;
+
+    std::vector<std::thread> threads;
+    std::vector<bool> is_valid(threads_count, false);
+    for (size_t t = 0; t < threads_count; ++t) {
+        threads.emplace_back([t, &cache, &is_valid]() -> void {
+            std::mt19937 rng(5 + t);
+            bool res = true;
+            for (size_t i = 0; i < TRANSFORMS_COUNT; ++i) {
+                const engine::board::grid_t g = random_transform(rng).apply((i % 2 == 0) ? td : tests::very_hard_td);
+                res = res && is_solution_of(g, cache.solve(g).solution);
+            }
+            is_valid[t] = res;
+        });
+    }
+    for (std::thread& th : threads) {
+        th.join();
+    }
+
+    EXPECTED(std::all_of(is_valid.begin(), is_valid.end(), [](bool v) -> bool { return v; }));
+    EXPECTED(cache.size() == 2);
+    EXPECTED(cache.hits() + cache.misses() == threads_count * TRANSFORMS_COUNT);
+}
+
+int main()
+{
+    return RUN_TESTS();
+}
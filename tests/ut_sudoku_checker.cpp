@@ -1,10 +1,16 @@
+#include <cstdint>
+#include <array>
 #include <limits>
 #include <string>
 
 #include "engine/board.h"
+#include "engine/board_view.h"
+#include "engine/budget.h"
+#include "engine/restart_policy.h"
 #include "engine/solver.h"
 #include "engine/details/checker.h"
 
+#include "fixtures.h"
 #include "testdefs.h"
 
 namespace {
@@ -91,17 +97,7 @@ TEST(sudoku_checker, hard)
 
 TEST(sudoku_checker, very_hard)
 {
-    const engine::board::grid_t td = {
-        {{0, 6, 0, 7, 2, 0, 0, 0, 0},
-         {0, 2, 0, 0, 9, 0, 0, 4, 7},
-         {0, 0, 0, 0, 0, 3, 0, 0, 0},
-         {0, 0, 1, 5, 0, 2, 0, 0, 9},
-         {8, 5, 0, 0, 0, 0, 0, 6, 2},
-         {6, 0, 0, 4, 0, 8, 3, 0, 0},
-         {0, 0, 0, 3, 0, 0, 0, 0, 0},
-         {7, 1, 0, 0, 5, 0, 0, 9, 0},
-         {0, 0, 0, 0, 8, 9, 0, 1, 0}}
-    };
+    const engine::board::grid_t& td = tests::very_hard_td;
 
     engine::details::checker checker;
 
@@ -113,19 +109,91 @@ TEST(sudoku_checker, very_hard)
 
 TEST(sudoku_checker, very_hard_repeat)
 {
-    const engine::board::grid_t td = {
-        {{0, 6, 0, 7, 2, 0, 0, 0, 0},
-         {0, 2, 0, 0, 9, 0, 0, 4, 7},
-         {0, 0, 0, 0, 0, 3, 0, 0, 0},
-         {0, 0, 1, 5, 0, 2, 0, 0, 9},
-         {8, 5, 0, 0, 0, 0, 0, 6, 2},
-         {6, 0, 0, 4, 0, 8, 3, 0, 0},
-         {0, 0, 0, 3, 0, 0, 0, 0, 0},
-         {7, 1, 0, 0, 5, 0, 0, 9, 0},
-         {0, 0, 0, 0, 8, 9, 0, 1, 0}}
-    };
+    const engine::board::grid_t& td = tests::very_hard_td;
+
+    engine::details::checker checker;
+    tests::histogram latency;
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        size_t solutions_count = 0;
+        {
+            const tests::histogram::scope scope(latency);
+            solutions_count = calc_solutions(checker, td);
+        }
+        EXPECTED(solutions_count == 1)
+            << "solutions_count: " << checker.solutions_count() << std::endl;
+        EXPECTED(checker.difficulty() == engine::details::checker::difficult::VERY_HARD)
+            << engine::details::checker::difficult_to_str(checker.difficulty()) << std::endl;
+    }
+    if (tests::perf_counters::is_enabled()) {
+        std::cout << "[ LATENCY  ] check: " << latency.report() << std::endl;
+    }
+}
+
+TEST(sudoku_checker, budget)
+{
+    const engine::board::grid_t& td = tests::very_hard_td;
+
+    size_t count = 0;
+    engine::budget small_bgt(1);
+    EXPECTED(engine::details::checker::calc_solutions(td, small_bgt, count) == engine::search_result::BUDGET_EXCEEDED);
+
+    engine::budget bgt(std::chrono::seconds(60));
+    EXPECTED(engine::details::checker::calc_solutions(td, bgt, count) == engine::search_result::SUCCESS);
+    EXPECTED(count == 1) << "solutions_count: " << count << std::endl;
+
+    const engine::board::grid_t empty = engine::board().grid();
+    engine::budget multi_bgt(std::chrono::seconds(60));
+    EXPECTED(engine::details::checker::calc_solutions(empty, multi_bgt, count, 5) == engine::search_result::SUCCESS);
+    EXPECTED(count >= 5) << "solutions_count: " << count << std::endl;
+
+    engine::details::checker::difficult dif = engine::details::checker::difficult::INVALID;
+    engine::budget dif_bgt(std::chrono::seconds(60));
+    EXPECTED(engine::details::checker::calc_difficulty(td, dif_bgt, dif) == engine::search_result::SUCCESS);
+    EXPECTED(dif == engine::details::checker::difficult::VERY_HARD)
+        << engine::details::checker::difficult_to_str(dif) << std::endl;
+
+    // Duplicate givens are rejected before the search spends a node.
+    engine::board::grid_t invalid = td;
+    invalid[0][0] = 6;
+    engine::budget invalid_bgt(1);
+    EXPECTED(engine::details::checker::calc_solutions(invalid, invalid_bgt, count) == engine::search_result::SUCCESS);
+    EXPECTED(count == 0) << "solutions_count: " << count << std::endl;
+    EXPECTED(engine::details::checker::calc_difficulty(invalid, invalid_bgt, dif) == engine::search_result::FAILURE);
+    EXPECTED(engine::details::checker::calc_solutions_parallel(invalid) == 0);
+
+    // Values out of range neither index the board tables nor count as digits.
+    invalid = td;
+    invalid[0][0] = 12;
+    invalid[4][4] = -1;
+    EXPECTED(engine::details::checker::calc_solutions(invalid) == 0);
+    EXPECTED(engine::details::checker::calc_difficulty(invalid) == engine::details::checker::difficult::INVALID);
+    EXPECTED(engine::details::checker::calc_solutions(invalid, invalid_bgt, count) == engine::search_result::SUCCESS);
+    EXPECTED(count == 0) << "solutions_count: " << count << std::endl;
+    EXPECTED(engine::details::checker::calc_difficulty(invalid, invalid_bgt, dif) == engine::search_result::FAILURE);
+    EXPECTED(engine::details::checker::calc_solutions_parallel(invalid) == 0);
+}
+
+TEST(sudoku_checker, very_hard_restarts)
+{
+    const engine::board::grid_t& td = tests::very_hard_td;
+
+    engine::details::checker checker;
+    checker.set_restart_policy(engine::restart_policy(engine::restart_policy::schedule::LUBY, 1));
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        EXPECTED(calc_solutions(checker, td) == 1)
+            << "solutions_count: " << checker.solutions_count() << std::endl;
+        EXPECTED(checker.difficulty() == engine::details::checker::difficult::VERY_HARD)
+            << engine::details::checker::difficult_to_str(checker.difficulty()) << std::endl;
+    }
+}
+
+TEST(sudoku_checker, very_hard_nogoods)
+{
+    const engine::board::grid_t& td = tests::very_hard_td;
 
     engine::details::checker checker;
+    checker.set_nogood_capacity(engine::details::nogood_store::DEFAULT_CAPACITY);
+    checker.set_restart_policy(engine::restart_policy(engine::restart_policy::schedule::LUBY, 1, false));
     for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
         EXPECTED(calc_solutions(checker, td) == 1)
             << "solutions_count: " << checker.solutions_count() << std::endl;
@@ -134,6 +202,197 @@ TEST(sudoku_checker, very_hard_repeat)
     }
 }
 
+TEST(sudoku_checker, parallel_solutions)
+{
+    const engine::board::grid_t& td = tests::very_hard_td;
+    const engine::board::grid_t& multi_td = tests::very_hard_multi_td;
+    const size_t exhaustive = std::numeric_limits<size_t>::max();
+
+    EXPECTED(engine::details::checker::calc_solutions_parallel(td, 2, 4) == 1);
+    EXPECTED(engine::details::checker::calc_solutions_parallel(td, exhaustive, 4) == 1);
+
+    const size_t etalon = engine::details::checker::calc_solutions(multi_td, exhaustive);
+    EXPECTED(etalon > 2) << "solutions_count: " << etalon << std::endl;
+    for (size_t threads = 1; threads <= 8; threads *= 2) {
+        const size_t count = engine::details::checker::calc_solutions_parallel(multi_td, exhaustive, threads);
+        EXPECTED(count == etalon)
+            << "threads: " << threads << ", solutions_count: " << count << ", etalon: " << etalon << std::endl;
+    }
+
+    const engine::board::grid_t empty = engine::board().grid();
+    EXPECTED(engine::details::checker::calc_solutions_parallel(empty, 100, 4) >= 100);
+}
+
+TEST(sudoku_checker, transposition_table)
+{
+    const engine::board::grid_t& multi_td = tests::very_hard_multi_td;
+    const size_t exhaustive = std::numeric_limits<size_t>::max();
+
+    engine::details::checker plain;
+    plain.set_transposition_size(0);
+    EXPECTED(plain.transposition_size() == 0);
+    plain.calc(multi_td, exhaustive);
+    const size_t etalon = plain.solutions_count();
+    EXPECTED(etalon > 2) << "solutions_count: " << etalon << std::endl;
+
+    engine::details::checker cached;
+    EXPECTED(cached.transposition_size() == engine::details::transposition_table::DEFAULT_SIZE);
+    for (size_t i = 0; i < 4; ++i) {
+        // Later runs start from the entries left by the previous ones.
+        cached.calc(multi_td, exhaustive);
+        EXPECTED(cached.solutions_count() == etalon)
+            << "iteration: " << i << ", solutions_count: " << cached.solutions_count()
+            << ", etalon: " << etalon << std::endl;
+
+        cached.calc(multi_td, 2);
+        EXPECTED(cached.solutions_count() >= 2)
+            << "iteration: " << i << ", solutions_count: " << cached.solutions_count() << std::endl;
+    }
+
+    cached.set_transposition_size(1);
+    cached.calc(multi_td, exhaustive);
+    EXPECTED(cached.solutions_count() == etalon)
+        << "solutions_count: " << cached.solutions_count() << ", etalon: " << etalon << std::endl;
+}
+
+TEST(sudoku_checker, context_reuse)
+{
+    const engine::board::grid_t easy_td = {
+        {{0, 0, 0, 0, 0, 7, 9, 4, 0},
+         {4, 0, 0, 5, 0, 0, 2, 0, 0},
+         {7, 6, 1, 0, 2, 0, 5, 0, 0},
+         {8, 0, 0, 0, 5, 0, 0, 9, 0},
+         {0, 0, 9, 1, 0, 2, 7, 0, 0},
+         {0, 7, 0, 0, 4, 0, 0, 0, 6},
+         {0, 0, 4, 0, 1, 0, 8, 7, 5},
+         {0, 0, 7, 0, 0, 4, 0, 0, 3},
+         {0, 8, 3, 2, 0, 0, 0, 0, 0}}
+    };
+    const engine::board::grid_t empty = engine::board().grid();
+
+    // One context serves grids of any difficulty in turn.
+    engine::details::checker checker;
+    for (size_t i = 0; i < 16; ++i) {
+        checker.calc((i % 2 == 0) ? easy_td : tests::very_hard_td);
+        EXPECTED(checker.solutions_count() == 1)
+            << "iteration: " << i << ", solutions_count: " << checker.solutions_count() << std::endl;
+        const engine::details::checker::difficult etalon = (i % 2 == 0)
+            ? engine::details::checker::difficult::EASY
+            : engine::details::checker::difficult::VERY_HARD;
+        EXPECTED(checker.difficulty() == etalon)
+            << "iteration: " << i << ", " << engine::details::checker::difficult_to_str(checker.difficulty())
+            << std::endl;
+
+        EXPECTED(engine::details::checker::calc_solutions(empty, 3) >= 3);
+        EXPECTED(engine::details::checker::calc_solutions(easy_td) == 1);
+        EXPECTED(engine::details::checker::calc_difficulty(tests::very_hard_td) ==
+                 engine::details::checker::difficult::VERY_HARD);
+        EXPECTED(engine::solver::can_solve(tests::very_hard_td));
+    }
+}
+
+TEST(sudoku_checker, templates)
+{
+    const engine::board::grid_t& td = tests::very_hard_td;
+    const engine::board::grid_t& multi_td = tests::very_hard_multi_td;
+    const size_t exhaustive = std::numeric_limits<size_t>::max();
+
+    EXPECTED(engine::details::all_templates().size() == engine::details::TEMPLATES_COUNT);
+
+    // Every template of the empty board fits, all cells are covered and none is forced.
+    const engine::board empty;
+    const engine::details::template_overlay o = engine::details::overlay_templates(empty, 1);
+    EXPECTED(o.count == engine::details::TEMPLATES_COUNT) << "count: " << o.count << std::endl;
+    for (size_t band = 0; band < engine::details::BANDS_COUNT; ++band) {
+        EXPECTED(o.cover[band] == engine::details::BAND_ALL_CELLS);
+        EXPECTED(o.forced[band] == 0);
+    }
+
+    // The overlay keeps the solution.
+    engine::solver sl;
+    engine::templates_solver tsl;
+    EXPECTED(sl.solve(td) && tsl.solve(td));
+    EXPECTED(tsl.get_grid() == sl.get_grid());
+
+    // Singles and pairs stall on td; the overlay still makes progress and keeps the solution.
+    engine::board stalled(td);
+    while (engine::details::subsets_pipeline::apply(stalled, engine::board::BEGIN_TAG)) {}
+    EXPECTED(! engine::solver::is_solved(stalled));
+    EXPECTED(engine::details::mark_templates(stalled, engine::board::BEGIN_TAG));
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        const engine::board::value_t v = sl.get_grid()[p / engine::board::COL_SIZE][p % engine::board::COL_SIZE];
+        EXPECTED(stalled.is_set_value(p) ? (stalled.value(p) == v) : stalled.is_possible(p, v)) << "cell: " << p << std::endl;
+    }
+
+    engine::details::checker checker;
+    engine::details::checker template_checker;
+    template_checker.set_templates_enabled(true);
+    EXPECTED(template_checker.is_templates_enabled());
+
+    engine::budget bgt;
+    engine::budget template_bgt;
+    size_t count = 0;
+    size_t template_count = 0;
+    EXPECTED(checker.count_solutions(td, bgt, count, exhaustive) == engine::search_result::SUCCESS);
+    EXPECTED(template_checker.count_solutions(td, template_bgt, template_count, exhaustive)
+             == engine::search_result::SUCCESS);
+    EXPECTED((count == 1) && (template_count == 1))
+        << "solutions_count: " << count << ", templates: " << template_count << std::endl;
+
+    template_checker.count_solutions(multi_td, template_bgt, template_count, exhaustive);
+    count = engine::details::checker::calc_solutions(multi_td, exhaustive);
+    EXPECTED(template_count == count) << "solutions_count: " << count << ", templates: " << template_count << std::endl;
+
+    // Rating does not use the templates.
+    checker.calc(td);
+    template_checker.calc(td);
+    EXPECTED(template_checker.difficulty() == checker.difficulty())
+        << engine::details::checker::difficult_to_str(template_checker.difficulty()) << std::endl;
+}
+
+TEST(sudoku_checker, board_view_storages)
+{
+    std::string text = "306508400520000000087000031003010080900863005050090600130000250000000074005206300";
+    const engine::text_board_view view(engine::text_storage(text.data()));
+    EXPECTED(engine::details::checker::calc_solutions(view) == 1);
+    EXPECTED(engine::details::checker::calc_difficulty(view) != engine::details::checker::difficult::INVALID);
+
+    engine::details::checker ch;
+    ch.calc(view);
+    EXPECTED(ch.solutions_count() == 1) << "solutions_count: " << ch.solutions_count() << std::endl;
+
+    text[1] = '3';
+    EXPECTED(engine::details::checker::calc_solutions(view) == 0);
+
+    // Bytes that are not digits are rejected, not loaded as digits.
+    for (const char c : {' ', 'x', '/', ':', '\xff'}) {
+        text[1] = c;
+        EXPECTED(engine::details::checker::calc_solutions(view) == 0) << "character: " << int(c) << std::endl;
+        EXPECTED(engine::details::checker::calc_difficulty(view) == engine::details::checker::difficult::INVALID)
+            << "character: " << int(c) << std::endl;
+    }
+
+    // A read-only buffer is checked in place.
+    const std::string line = "306508400520000000087000031003010080900863005050090600130000250000000074005206300";
+    const engine::const_text_board_view const_view(engine::const_text_storage(line.data()));
+    EXPECTED(engine::details::checker::calc_solutions(const_view) == 1);
+
+    std::array<uint8_t, engine::nibble_storage::SIZE> bytes = {};
+    engine::nibble_board_view nibble_view((engine::nibble_storage(bytes.data())));
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        nibble_view.set_value(p, const_view.value(p));
+    }
+    const std::array<uint8_t, engine::nibble_storage::SIZE>& const_bytes = bytes;
+    const engine::const_nibble_board_view const_nibble_view((engine::const_nibble_storage(const_bytes.data())));
+    EXPECTED(engine::details::checker::calc_solutions(const_nibble_view) == 1);
+    for (const uint8_t nibble : {0x0a, 0x0f}) {
+        bytes[1] = static_cast<uint8_t>((bytes[1] & 0x0f) | (nibble << 4));
+        EXPECTED(engine::details::checker::calc_solutions(const_nibble_view) == 0) << "nibble: " << int(nibble) << std::endl;
+        EXPECTED(engine::details::checker::calc_difficulty(const_nibble_view) == engine::details::checker::difficult::INVALID)
+            << "nibble: " << int(nibble) << std::endl;
+    }
+}
+
 int main()
 {
     return RUN_TESTS();
@@ -0,0 +1,156 @@
+#include <string>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/codec.h"
+#include "engine/generator.h"
+
+#include "fixtures.h"
+#include "testdefs.h"
+
+using tests::print;
+
+namespace {
+
+constexpr size_t GRIDS_COUNT = 32;
+
+const engine::board::grid_t td = {
+    {{3, 0, 6, 5, 0, 8, 4, 0, 0},
+     {5, 2, 0, 0, 0, 0, 0, 0, 0},
+     {0, 8, 7, 0, 0, 0, 0, 3, 1},
+     {0, 0, 3, 0, 1, 0, 0, 8, 0},
+     {9, 0, 0, 8, 6, 3, 0, 0, 5},
+     {0, 5, 0, 0, 9, 0, 6, 0, 0},
+     {1, 3, 0, 0, 0, 0, 2, 5, 0},
+     {0, 0, 0, 0, 0, 0, 0, 7, 4},
+     {0, 0, 5, 2, 0, 6, 3, 0, 0}}
+};
+
+size_t givens_count(const engine::board::grid_t& g)
+{
+    size_t count = 0;
+    for (const engine::board::row_t& row : g) {
+        for (const engine::board::value_t v : row) {
+            count += (v != 0) ? 1 : 0;
+        }
+    }
+    return count;
+}
+
+} // <anonymous> namespace
+
+TEST(sudoku_codec, puzzle)
+{
+    engine::codec::puzzle_t rec;
+    const size_t size = engine::codec::encode_puzzle(td, rec);
+    EXPECTED(size == engine::codec::BITMAP_SIZE + (givens_count(td) + 1) / 2) << "size: " << size << std::endl;
+    EXPECTED(engine::codec::puzzle_size(rec.data()) == size);
+
+    engine::board::grid_t g;
+    EXPECTED(engine::codec::decode_puzzle(rec.data(), size, g) == size);
+    EXPECTED(g == td) << "Decoded grid:" << std::endl << print(g) << std::endl;
+
+    // A full and an empty grid are the longest and the shortest records.
+    const engine::board::grid_t full = engine::generator::generate_grid();
+    EXPECTED(engine::codec::encode_puzzle(full, rec) == engine::codec::MAX_PUZZLE_SIZE);
+    EXPECTED(engine::codec::decode_puzzle(rec.data(), rec.size(), g) == rec.size());
+    EXPECTED(g == full);
+
+    const engine::board::grid_t empty = engine::board().grid();
+    EXPECTED(engine::codec::encode_puzzle(empty, rec) == engine::codec::BITMAP_SIZE);
+    EXPECTED(engine::codec::decode_puzzle(rec.data(), engine::codec::BITMAP_SIZE, g) == engine::codec::BITMAP_SIZE);
+    EXPECTED(g == empty);
+}
+
+TEST(sudoku_codec, puzzle_stream)
+{
+    engine::generator gen;
+    std::vector<engine::board::grid_t> puzzles;
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; i < GRIDS_COUNT; ++i) {
+        puzzles.push_back(gen.generate());
+        engine::codec::puzzle_t rec;
+        const size_t size = engine::codec::encode_puzzle(puzzles.back(), rec);
+        stream.insert(stream.end(), rec.begin(), rec.begin() + size);
+    }
+
+    size_t pos = 0;
+    for (const engine::board::grid_t& puzzle : puzzles) {
+        engine::board::grid_t g;
+        const size_t size = engine::codec::decode_puzzle(stream.data() + pos, stream.size() - pos, g);
+        EXPECTED(size != 0);
+        EXPECTED(g == puzzle) << "Decoded grid:" << std::endl << print(g) << std::endl;
+        pos += size;
+    }
+    EXPECTED(pos == stream.size());
+}
+
+TEST(sudoku_codec, puzzle_malformed)
+{
+    engine::codec::puzzle_t rec;
+    const size_t size = engine::codec::encode_puzzle(td, rec);
+    engine::board::grid_t g;
+
+    EXPECTED(engine::codec::decode_puzzle(rec.data(), size - 1, g) == 0);
+    EXPECTED(engine::codec::decode_puzzle(rec.data(), engine::codec::BITMAP_SIZE - 1, g) == 0);
+
+    engine::codec::puzzle_t bad = rec;
+    bad[engine::codec::BITMAP_SIZE] = 0xa0 | (bad[engine::codec::BITMAP_SIZE] & 0x0f);
+    EXPECTED(engine::codec::decode_puzzle(bad.data(), size, g) == 0);
+
+    bad = rec;
+    bad[engine::codec::BITMAP_SIZE - 1] |= 0x80;
+    EXPECTED(engine::codec::decode_puzzle(bad.data(), bad.size(), g) == 0);
+}
+
+TEST(sudoku_codec, solution)
+{
+    EXPECTED(engine::codec::SOLUTION_SIZE == 19);
+
+    for (size_t i = 0; i < GRIDS_COUNT; ++i) {
+        const engine::board::grid_t grid = engine::generator::generate_grid();
+        const engine::codec::solution_t rec = engine::codec::encode_solution(grid);
+
+        engine::board::grid_t g;
+        EXPECTED(engine::codec::decode_solution(rec, g));
+        EXPECTED(g == grid) << "Decoded grid:" << std::endl << print(g) << std::endl
+                            << "Etalon grid:" << std::endl << print(grid) << std::endl;
+    }
+}
+
+TEST(sudoku_codec, solution_malformed)
+{
+    engine::codec::solution_t rec = engine::codec::encode_solution(engine::generator::generate_grid());
+    engine::board::grid_t g;
+
+    // Row 0 code 2^19 - 1 is past 9!.
+    engine::codec::solution_t bad = rec;
+    bad[0] = 0xff;
+    bad[1] = 0xff;
+    bad[2] |= 0x07;
+    EXPECTED(! engine::codec::decode_solution(bad, g));
+
+    // Rows 0 and 1 equal leave two digits missing in every column.
+    bad = rec;
+    bad[2] = (bad[2] & 0x07) | static_cast<uint8_t>(bad[0] << 3);
+    bad[3] = static_cast<uint8_t>((bad[0] >> 5) | (bad[1] << 3));
+    bad[4] = static_cast<uint8_t>((bad[4] & 0xc0) | (bad[1] >> 5) | ((rec[2] & 0x07) << 3));
+    EXPECTED(! engine::codec::decode_solution(bad, g));
+
+    // A latin square of shifted rows: rows and columns are complete, the boxes repeat digits.
+    engine::board::grid_t latin;
+    for (size_t r = 0; r < engine::board::ROW_SIZE; ++r) {
+        for (size_t c = 0; c < engine::board::COL_SIZE; ++c) {
+            latin[r][c] = static_cast<engine::board::value_t>((r + c) % engine::board::COL_SIZE + 1);
+        }
+    }
+    const engine::board::grid_t etalon = engine::generator::generate_grid();
+    g = etalon;
+    EXPECTED(! engine::codec::decode_solution(engine::codec::encode_solution(latin), g));
+    EXPECTED(g == etalon) << "Decoded grid:" << std::endl << print(g) << std::endl;
+}
+
+int main()
+{
+    return RUN_TESTS();
+}
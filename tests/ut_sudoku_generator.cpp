@@ -1,13 +1,18 @@
 #include <limits>
-#include <sstream>
 #include <string>
+#include <thread>
 
+#include "engine/arena.h"
 #include "engine/board.h"
+#include "engine/budget.h"
 #include "engine/generator.h"
 #include "engine/solver.h"
 
+#include "fixtures.h"
 #include "testdefs.h"
 
+using tests::print;
+
 namespace {
 
 engine::board::grid_t generate(engine::generator& gen, const engine::generator::difficult dif)
@@ -21,18 +26,6 @@ engine::board::grid_t generate(engine::generator& gen, const engine::generator::
     return g;
 }
 
-std::string print(const engine::board::grid_t& board)
-{
-    std::stringstream ss;
-    for (size_t i = 0; i < board.size(); ++i) {
-        for (size_t j = 0; j < board[i].size(); ++j) {
-            ss << (size_t)board[i][j] << " ";
-        }
-        ss << std::endl;
-    }
-    return ss.str();
-}
-
 } // <anonymous> namespace
 
 TEST(sudoku_generator, easy)
@@ -121,6 +114,114 @@ TEST(sudoku_generator, very_hard)
         << "Generated grid:" << std::endl << print(gen_grid) << std::endl;
 }
 
+TEST(sudoku_generator, budget)
+{
+    engine::generator gen;
+    engine::board::grid_t gen_grid;
+
+    engine::budget small_bgt(1);
+    EXPECTED(gen.generate(gen_grid, small_bgt) == engine::search_result::BUDGET_EXCEEDED);
+
+    engine::budget expired_bgt(std::chrono::nanoseconds(0));
+    EXPECTED(gen.generate(gen_grid, expired_bgt) == engine::search_result::BUDGET_EXCEEDED);
+
+    engine::budget bgt(std::chrono::seconds(60));
+    EXPECTED(gen.generate(gen_grid, bgt) == engine::search_result::SUCCESS);
+    EXPECTED(engine::solver::can_solve(gen_grid));
+    EXPECTED(gen.solutions_count() == 1)
+        << "solutions count: " << gen.solutions_count() << std::endl
+        << "Generated grid:" << std::endl << print(gen_grid) << std::endl;
+}
+
+TEST(sudoku_generator, arena)
+{
+    engine::arena job_arena;
+    for (size_t i = 0; i < 4; ++i) {
+        {
+            engine::generator gen(job_arena.resource());
+            engine::budget bgt(std::chrono::seconds(60));
+            engine::board::grid_t gen_grid;
+            EXPECTED(gen.generate(gen_grid, bgt) == engine::search_result::SUCCESS);
+            EXPECTED(engine::solver::can_solve(gen_grid));
+            EXPECTED(gen.solutions_count() == 1)
+                << "solutions count: " << gen.solutions_count() << std::endl
+                << "Generated grid:" << std::endl << print(gen_grid) << std::endl;
+        }
+        job_arena.release();
+    }
+}
+
+TEST(sudoku_generator, move)
+{
+    engine::arena job_arena;
+    engine::generator gen(job_arena.resource());
+    engine::generator moved(std::move(gen));
+    EXPECTED(engine::solver::can_solve(moved.generate()));
+
+    gen = std::move(moved);
+    EXPECTED(engine::solver::can_solve(gen.generate()));
+    EXPECTED(gen.solutions_count() == 1) << "solutions count: " << gen.solutions_count() << std::endl;
+}
+
+TEST(sudoku_generator, stats)
+{
+    constexpr size_t GRIDS_COUNT = 16;
+
+    engine::generator::reset_total_stats();
+    engine::generator gen;
+    tests::histogram latency;
+    for (size_t i = 0; i < GRIDS_COUNT; ++i) {
+        engine::board::grid_t g;
+        {
+            const tests::histogram::scope scope(latency);
+            g = gen.generate();
+        }
+
+        size_t givens = 0;
+        for (const engine::board::row_t& row : g) {
+            for (const engine::board::value_t v : row) {
+                givens += (v != 0) ? 1 : 0;
+            }
+        }
+        const engine::generator::stats& st = gen.last_stats();
+        EXPECTED(st.calls == 1);
+        EXPECTED(st.removals_accepted == engine::board::BOARD_SIZE - givens)
+            << "accepted: " << st.removals_accepted << ", givens: " << givens << std::endl;
+        EXPECTED(st.solutions_calls == st.removals_accepted + st.removals_rejected);
+        EXPECTED(st.solutions_time.count() > 0);
+        EXPECTED(st.difficulties[static_cast<size_t>(gen.difficulty())] == 1);
+    }
+
+    // Counters of finished threads are kept.
+    tests::histogram th_latency;
+    std::thread th([&th_latency]() -> void {
+        engine::generator th_gen;
+        const tests::histogram::scope scope(th_latency);
+        th_gen.generate();
+    });
+    th.join();
+    latency += th_latency;
+    EXPECTED(latency.count() == GRIDS_COUNT + 1);
+    EXPECTED(latency.percentile(50) <= latency.percentile(99) && latency.percentile(99) <= latency.max());
+    if (tests::perf_counters::is_enabled()) {
+        std::cout << "[ LATENCY  ] generate: " << latency.report() << std::endl;
+    }
+
+    const engine::generator::stats total = engine::generator::total_stats();
+    EXPECTED(total.calls == GRIDS_COUNT + 1) << "calls: " << total.calls << std::endl;
+    size_t rated = 0;
+    for (const size_t count : total.difficulties) {
+        rated += count;
+    }
+    EXPECTED(rated == total.calls);
+    EXPECTED(total.solutions_calls == total.removals_accepted + total.removals_rejected);
+    EXPECTED(total.attempts(engine::generator::difficult::EASY) >= 1.0
+             || total.difficulties[static_cast<size_t>(engine::generator::difficult::EASY)] == 0);
+
+    engine::generator::reset_total_stats();
+    EXPECTED(engine::generator::total_stats().calls == 0);
+}
+
 int main()
 {
     return RUN_TESTS();
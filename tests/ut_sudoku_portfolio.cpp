@@ -0,0 +1,110 @@
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <string>
+
+#include "engine/board.h"
+#include "engine/budget.h"
+#include "engine/portfolio.h"
+#include "engine/solver.h"
+#include "engine/details/utils.h"
+
+#include "fixtures.h"
+#include "testdefs.h"
+
+using tests::print;
+
+TEST(sudoku_portfolio, solve)
+{
+    engine::portfolio pf(engine::portfolio::default_configs(4));
+
+    EXPECTED(pf.solve(tests::guess_td));
+    EXPECTED(pf.winner() < pf.configs().size()) << "winner: " << pf.winner() << std::endl;
+
+    const engine::board::grid_t res = pf.get_grid();
+    EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+}
+
+TEST(sudoku_portfolio, solve_repeat)
+{
+    engine::portfolio pf;
+
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        EXPECTED(pf.solve(tests::guess_td));
+
+        const engine::board::grid_t res = pf.get_grid();
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+}
+
+TEST(sudoku_portfolio, single_config)
+{
+    engine::portfolio pf(engine::portfolio::default_configs(1));
+
+    EXPECTED(pf.solve(tests::guess_td));
+    EXPECTED(pf.winner() == 0) << "winner: " << pf.winner() << std::endl;
+    EXPECTED(engine::solver::is_solved(pf.get_grid()));
+}
+
+TEST(sudoku_portfolio, caller_random_engine)
+{
+    // Members seed their own thread's engine; the caller's sequence must continue untouched.
+    engine::details::seed_random(42);
+    const engine::details::random_engine_t etalon = engine::details::random_engine();
+
+    engine::portfolio pf(engine::portfolio::default_configs(2));
+    EXPECTED(pf.solve(tests::guess_td));
+    EXPECTED(engine::details::random_engine() == etalon);
+}
+
+TEST(sudoku_portfolio, budget)
+{
+    engine::portfolio pf(engine::portfolio::default_configs(4));
+
+    EXPECTED(pf.solve(tests::guess_td, engine::budget(1)) == engine::search_result::BUDGET_EXCEEDED);
+    EXPECTED(pf.winner() == engine::portfolio::INVALID_WINNER) << "winner: " << pf.winner() << std::endl;
+
+    EXPECTED(pf.solve(tests::guess_td, engine::budget(std::chrono::seconds(60))) == engine::search_result::SUCCESS);
+    EXPECTED(tests::guess_etalon == pf.get_grid());
+
+    // A failed solve does not leave the previous solution behind.
+    engine::board::grid_t invalid = tests::guess_td;
+    invalid[0][0] = 8;
+    EXPECTED(pf.solve(invalid, engine::budget(std::chrono::seconds(60))) == engine::search_result::FAILURE);
+    EXPECTED(pf.get_grid() == engine::board::grid_t{}) << print(pf.get_grid()) << std::endl;
+
+    // Members split the nodes of the caller.
+    const engine::budget parent(10);
+    engine::budget share = parent.share(4);
+    EXPECTED(share.spend() && share.spend() && ! share.spend());
+    const engine::budget unlimited_parent;
+    engine::budget unlimited = unlimited_parent.share(4);
+    for (size_t i = 0; i < 1000; ++i) {
+        EXPECTED(unlimited.spend());
+    }
+}
+
+TEST(sudoku_portfolio, cancel)
+{
+    std::atomic<bool> is_cancel(true);
+    engine::budget bgt;
+    bgt.set_cancel_flag(&is_cancel);
+
+    engine::solver sl;
+    EXPECTED(sl.solve(tests::guess_td, bgt) == engine::search_result::BUDGET_EXCEEDED);
+    EXPECTED(bgt.is_cancelled());
+
+    // The caller's flag stops every member of a portfolio.
+    engine::portfolio pf(engine::portfolio::default_configs(4));
+    EXPECTED(pf.solve(tests::guess_td));
+    engine::budget pf_bgt;
+    pf_bgt.set_cancel_flag(&is_cancel);
+    EXPECTED(pf.solve(tests::guess_td, pf_bgt) == engine::search_result::BUDGET_EXCEEDED);
+    EXPECTED(pf.winner() == engine::portfolio::INVALID_WINNER) << "winner: " << pf.winner() << std::endl;
+    EXPECTED(pf.get_grid() == engine::board::grid_t{}) << print(pf.get_grid()) << std::endl;
+}
+
+int main()
+{
+    return RUN_TESTS();
+}
@@ -1,27 +1,23 @@
 #include <limits>
-#include <sstream>
+#include <memory>
+#include <vector>
 #include <string>
 
+#include "engine/batch_solver.h"
+#include "engine/bitboard_solver.h"
+#include "engine/budget.h"
+#include "engine/counters.h"
+#include "engine/generator.h"
+#include "engine/restart_policy.h"
 #include "engine/solver.h"
+#include "engine/details/checker.h"
+#include "engine/details/cpu_dispatch.h"
 #include "engine/details/utils.h"
 
+#include "fixtures.h"
 #include "testdefs.h"
 
-namespace {
-
-std::string print(const engine::board::grid_t& board)
-{
-    std::stringstream ss;
-    for (size_t i = 0; i < board.size(); ++i) {
-        for (size_t j = 0; j < board[i].size(); ++j) {
-            ss << (size_t)board[i][j] << " ";
-        }
-        ss << std::endl;
-    }
-    return ss.str();
-}
-
-} // <anonymous> namespace
+using tests::print;
 
 TEST(sudoku_solver, single_solve)
 {
@@ -95,57 +91,375 @@ TEST(sudoku_solver, guess_case_1)
 
 TEST(sudoku_solver, guess_case_2)
 {
-    const engine::board::grid_t td = {
-        {{0, 8, 0, 0, 0, 0, 0, 2, 0},
-         {5, 9, 0, 0, 3, 0, 0, 4, 1},
-         {4, 0, 0, 9, 0, 5, 0, 0, 6},
-         {0, 0, 0, 2, 7, 3, 0, 0, 0},
-         {0, 0, 0, 8, 0, 9, 0, 0, 0},
-         {9, 0, 0, 0, 1, 0, 0, 0, 2},
-         {0, 7, 0, 0, 0, 0, 0, 1, 0},
-         {0, 3, 9, 0, 0, 0, 2, 5, 0},
-         {2, 0, 0, 0, 0, 0, 0, 0, 4}}
-    };
-    const engine::board::grid_t etalon = {
-        {{7, 8, 3, 4, 6, 1, 5, 2, 9},
-         {5, 9, 6, 7, 3, 2, 8, 4, 1},
-         {4, 2, 1, 9, 8, 5, 7, 3, 6},
-         {1, 6, 8, 2, 7, 3, 4, 9, 5},
-         {3, 4, 2, 8, 5, 9, 1, 6, 7},
-         {9, 5, 7, 6, 1, 4, 3, 8, 2},
-         {8, 7, 4, 5, 2, 6, 9, 1, 3},
-         {6, 3, 9, 1, 4, 7, 2, 5, 8},
-         {2, 1, 5, 3, 9, 8, 6, 7, 4}}
-    };
-
     engine::solver sl;
 
-    EXPECTED(sl.solve(td));
+    EXPECTED(sl.solve(tests::guess_td));
     const engine::board::grid_t res = sl.get_grid();
 
     EXPECTED(engine::solver::is_solved(res));
-    EXPECTED(etalon == res) << "Etalon: " << std::endl << print(etalon) << std::endl
-                            << "Test result: " << std::endl << print(res) << std::endl;
+    EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
 }
 
 TEST(sudoku_solver, guess_case_repeat)
 {
-    const engine::board::grid_t td = {
-        {{0, 8, 0, 0, 0, 0, 0, 2, 0},
-         {5, 9, 0, 0, 3, 0, 0, 4, 1},
-         {4, 0, 0, 9, 0, 5, 0, 0, 6},
-         {0, 0, 0, 2, 7, 3, 0, 0, 0},
-         {0, 0, 0, 8, 0, 9, 0, 0, 0},
-         {9, 0, 0, 0, 1, 0, 0, 0, 2},
-         {0, 7, 0, 0, 0, 0, 0, 1, 0},
-         {0, 3, 9, 0, 0, 0, 2, 5, 0},
-         {2, 0, 0, 0, 0, 0, 0, 0, 4}}
-    };
+    tests::histogram latency;
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        engine::solver sl;
+        bool is_solved = false;
+        {
+            const tests::histogram::scope scope(latency);
+            is_solved = sl.solve(tests::guess_td);
+        }
+        EXPECTED(is_solved);
+    }
+    EXPECTED(latency.count() == std::numeric_limits<char>::max());
+    if (tests::perf_counters::is_enabled()) {
+        std::cout << "[ LATENCY  ] solve: " << latency.report() << std::endl;
+    }
+}
+
+TEST(sudoku_solver, probing_guess_cell)
+{
+    engine::counters::reset();
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        engine::solver sl;
+        sl.set_probing(engine::solver::probing::GUESS_CELL);
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+
+        EXPECTED(engine::solver::is_solved(res));
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+
+    // Singles only place values, so every elimination comes from a failed probe.
+    if (engine::counters::IS_ENABLED) {
+        EXPECTED(engine::counters::local().set_impossibles > 0) << engine::counters::local().to_json() << std::endl;
+    }
+}
+
+TEST(sudoku_solver, probing_bivalue_cells)
+{
+    engine::counters::reset();
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        EXPECTED(engine::solver().solve(tests::guess_td));
+    }
+    const size_t plain_guesses = engine::counters::local().guesses;
+
+    engine::counters::reset();
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        engine::solver sl;
+        sl.set_probing(engine::solver::probing::BIVALUE_CELLS);
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+
+        EXPECTED(engine::solver::is_solved(res));
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+
+    // Probing the two-candidate cells settles most of them before a guess is needed.
+    if (engine::counters::IS_ENABLED) {
+        const engine::counters& c = engine::counters::local();
+        EXPECTED(c.set_impossibles > 0 && c.guesses < plain_guesses)
+            << "guesses: " << c.guesses << ", without probing: " << plain_guesses << std::endl;
+    }
+}
+
+TEST(sudoku_solver, budget)
+{
+    engine::solver sl;
+
+    engine::budget small_bgt(1);
+    EXPECTED(sl.solve(tests::guess_td, small_bgt) == engine::search_result::BUDGET_EXCEEDED);
+    EXPECTED(small_bgt.is_exceeded());
+
+    engine::budget bgt(std::chrono::seconds(60));
+    EXPECTED(sl.solve(tests::guess_td, bgt) == engine::search_result::SUCCESS);
+    EXPECTED(! bgt.is_exceeded());
+    EXPECTED(engine::solver::is_solved(sl.get_grid()));
+
+    // Duplicate givens fail without spending a node.
+    engine::board::grid_t invalid = tests::guess_td;
+    invalid[0][0] = 8;
+    engine::budget invalid_bgt(1);
+    EXPECTED(sl.solve(invalid, invalid_bgt) == engine::search_result::FAILURE);
+    EXPECTED(! invalid_bgt.is_exceeded());
+    EXPECTED(! engine::solver::can_solve(invalid));
+
+    // Values out of range neither index the board tables nor count as digits.
+    invalid = tests::guess_td;
+    invalid[0][0] = 12;
+    EXPECTED(sl.solve(invalid, invalid_bgt) == engine::search_result::FAILURE);
+    EXPECTED(! engine::solver::can_solve(invalid));
+    invalid[0][0] = -1;
+    EXPECTED(! engine::solver::can_solve(invalid));
+}
+
+TEST(sudoku_solver, luby_sequence)
+{
+    const size_t etalon[] = {1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, 1};
+    for (size_t i = 0; i < sizeof(etalon) / sizeof(etalon[0]); ++i) {
+        EXPECTED(engine::restart_policy::luby(i + 1) == etalon[i])
+            << "luby(" << i + 1 << ") = " << engine::restart_policy::luby(i + 1) << std::endl;
+    }
+}
+
+TEST(sudoku_solver, restart_limits)
+{
+    // A zero base is clamped to one, so no schedule gets stuck at a zero limit.
+    for (const size_t base : {0, 1}) {
+        engine::restart_policy luby(engine::restart_policy::schedule::LUBY, base);
+        engine::restart_policy geometric(engine::restart_policy::schedule::GEOMETRIC, base);
+
+        const size_t luby_etalon[] = {1, 1, 2, 1, 1, 2, 4, 1};
+        const size_t geometric_etalon[] = {1, 2, 3, 4, 6, 9, 13, 19};
+        for (size_t i = 0; i < sizeof(luby_etalon) / sizeof(luby_etalon[0]); ++i) {
+            EXPECTED(luby.limit() == luby_etalon[i])
+                << "base " << base << ", luby limit " << i << " = " << luby.limit() << std::endl;
+            EXPECTED(geometric.limit() == geometric_etalon[i])
+                << "base " << base << ", geometric limit " << i << " = " << geometric.limit() << std::endl;
+            luby.next();
+            geometric.next();
+        }
+    }
+}
+
+TEST(sudoku_solver, restarts_luby)
+{
+    size_t restarts = 0;
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        engine::solver sl;
+        sl.set_restart_policy(engine::restart_policy(engine::restart_policy::schedule::LUBY, 1, true));
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+        restarts += sl.restart_mode().restarts();
+
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+    EXPECTED(restarts > 0);
+}
+
+TEST(sudoku_solver, nogoods)
+{
+    engine::solver sl;
+    EXPECTED(sl.nogood_capacity() == 0);
+    EXPECTED(sl.solve(tests::guess_td) && sl.nogoods_count() == 0);
 
+    sl.set_nogood_capacity(engine::details::nogood_store::DEFAULT_CAPACITY);
+    size_t learned = 0;
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        // Nogoods outlive restarts, where the guess order changes.
+        const engine::restart_policy::schedule s = (i % 2 == 0) ? engine::restart_policy::schedule::NONE
+                                                                 : engine::restart_policy::schedule::LUBY;
+        sl.set_restart_policy(engine::restart_policy(s, 1, false));
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+        learned += sl.nogoods_count();
+
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+    EXPECTED(learned > 0);
+}
+
+TEST(sudoku_solver, restarts_geometric)
+{
+    size_t restarts[2] = {0, 0};
     for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
         engine::solver sl;
-        EXPECTED(sl.solve(td));
+        const size_t base = (i % 2 == 0) ? 4 : 1;
+        sl.set_restart_policy(engine::restart_policy(engine::restart_policy::schedule::GEOMETRIC, base, false));
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+        restarts[i % 2] += sl.restart_mode().restarts();
+
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+    EXPECTED(restarts[0] > 0 && restarts[1] > 0) << "base 4: " << restarts[0] << ", base 1: " << restarts[1] << std::endl;
+}
+
+TEST(sudoku_solver, subsets_solver)
+{
+    engine::counters::reset();
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        EXPECTED(engine::solver().solve(tests::guess_td));
+    }
+    const size_t singles_guesses = engine::counters::local().guesses;
+
+    engine::counters::reset();
+    for (size_t i = 0; i < std::numeric_limits<char>::max(); ++i) {
+        engine::subsets_solver sl;
+
+        EXPECTED(sl.solve(tests::guess_td));
+        const engine::board::grid_t res = sl.get_grid();
+
+        EXPECTED(tests::guess_etalon == res) << "Test result: " << std::endl << print(res) << std::endl;
+    }
+
+    // The pair techniques eliminate candidates, so fewer cells are left to guess.
+    if (engine::counters::IS_ENABLED) {
+        const engine::counters& c = engine::counters::local();
+        EXPECTED(c.set_impossibles > 0 && c.guesses < singles_guesses)
+            << "guesses: " << c.guesses << ", singles: " << singles_guesses << std::endl;
+    }
+}
+
+TEST(sudoku_solver, batch_solver)
+{
+    // Two and a half batches: generated puzzles, one needing a search and two without a solution.
+    engine::generator gen;
+    std::vector<engine::board::grid_t> puzzles;
+    for (size_t i = 0; i < 2 * engine::batch_solver::LANES + engine::batch_solver::LANES / 2 - 3; ++i) {
+        puzzles.push_back(gen.generate());
+    }
+    puzzles.push_back(tests::very_hard_td);
+    engine::board::grid_t duplicate = tests::very_hard_td;
+    duplicate[0][0] = 6;
+    puzzles.push_back(duplicate);
+    engine::board::grid_t impossible = tests::very_hard_td;
+    impossible[0][0] = 1;
+    impossible[0][2] = 3;
+    impossible[2][0] = 4;
+    puzzles.push_back(impossible);
+
+    std::vector<engine::board::grid_t> grids = puzzles;
+    std::vector<engine::search_result> results(grids.size(), engine::search_result::BUDGET_EXCEEDED);
+    engine::batch_solver bs;
+    std::unique_ptr<tests::perf_counters> p_perf;
+    if (tests::perf_counters::is_enabled()) {
+        p_perf = std::make_unique<tests::perf_counters>(true);
+    }
+    bs.solve(grids.data(), grids.size(), results.data());
+    if (p_perf) {
+        p_perf->pause();
+        if (p_perf->is_available()) {
+            std::cout << "[   PERF   ] per puzzle: " << p_perf->report(grids.size()) << std::endl;
+        }
+    }
+
+    engine::solver sl;
+    for (size_t i = 0; i < puzzles.size(); ++i) {
+        const bool is_solved = sl.solve(puzzles[i]);
+        EXPECTED(is_solved == (results[i] == engine::search_result::SUCCESS))
+            << "puzzle: " << i << std::endl << print(puzzles[i]) << std::endl;
+        if (is_solved) {
+            EXPECTED(grids[i] == sl.get_grid()) << "Batch result: " << std::endl << print(grids[i]) << std::endl
+                                                << "Solver result: " << std::endl << print(sl.get_grid()) << std::endl;
+        } else {
+            EXPECTED(grids[i] == puzzles[i]);
+        }
+    }
+    EXPECTED(results[puzzles.size() - 2] == engine::search_result::FAILURE);
+    EXPECTED(bs.propagated() + bs.searched() <= puzzles.size() - 1)
+        << "propagated: " << bs.propagated() << ", searched: " << bs.searched() << std::endl;
+    EXPECTED(bs.searched() >= 1);
+}
+
+TEST(sudoku_solver, bitboard_solver)
+{
+    engine::solver sl;
+    engine::bitboard_solver bs;
+    EXPECTED(sl.solve(tests::very_hard_td));
+    EXPECTED(bs.solve(tests::very_hard_td));
+    EXPECTED(bs.get_grid() == sl.get_grid()) << "Bitboard result: " << std::endl << print(bs.get_grid()) << std::endl
+                                             << "Solver result: " << std::endl << print(sl.get_grid()) << std::endl;
+    EXPECTED(engine::bitboard_solver::calc_solutions(tests::very_hard_td) == 1);
+
+    engine::generator gen;
+    for (size_t i = 0; i < 32; ++i) {
+        const engine::board::grid_t g = gen.generate();
+        EXPECTED(bs.solve(g) && sl.solve(g));
+        EXPECTED(bs.get_grid() == sl.get_grid());
+    }
+
+    // Counting stops at the limit and keeps the first solution.
+    const engine::board::grid_t empty = engine::board().grid();
+    bs.reset(empty);
+    EXPECTED(bs.count_solutions(100) == 100);
+    EXPECTED(engine::solver::is_solved(bs.get_grid()));
+
+    engine::board::grid_t multi = tests::very_hard_td;
+    multi[0][1] = 0;
+    multi[0][3] = 0;
+    multi[1][4] = 0;
+    size_t count = 0;
+    engine::budget bgt;
+    EXPECTED(bs.count_solutions(multi, bgt, count, 1000) == engine::search_result::SUCCESS);
+    EXPECTED(count == engine::details::checker::calc_solutions(multi, 1000))
+        << "solutions_count: " << count << std::endl;
+
+    engine::budget small_bgt(1);
+    EXPECTED(bs.solve(tests::very_hard_td, small_bgt) == engine::search_result::BUDGET_EXCEEDED);
+    EXPECTED(engine::bitboard_solver::can_solve(tests::very_hard_td, small_bgt) == engine::search_result::BUDGET_EXCEEDED);
+
+    engine::board::grid_t invalid = tests::very_hard_td;
+    invalid[0][0] = 6;
+    EXPECTED(! engine::bitboard_solver::can_solve(invalid));
+    EXPECTED(engine::bitboard_solver::calc_solutions(invalid) == 0);
+}
+
+TEST(sudoku_solver, isa_levels)
+{
+    engine::generator gen;
+    std::vector<engine::board::grid_t> puzzles;
+    for (size_t i = 0; i < 2 * engine::batch_solver::LANES + 3; ++i) {
+        puzzles.push_back(gen.generate());
+    }
+    engine::board::grid_t duplicate = puzzles[0];
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        duplicate[p / engine::board::COL_SIZE][p % engine::board::COL_SIZE] = 1;
+    }
+    puzzles.push_back(duplicate);
+
+    // Every kernel build the CPU can run gives the results of the generic one. The empty grid has
+    // many solutions, the bitboard solver finds them in a fixed order.
+    const auto run_fn = [&puzzles](std::vector<engine::board::grid_t>& grids,
+                                   std::vector<engine::search_result>& results,
+                                   std::vector<size_t>& counts) -> void {
+        grids = puzzles;
+        results.assign(grids.size(), engine::search_result::BUDGET_EXCEEDED);
+        engine::batch_solver bs;
+        bs.solve(grids.data(), grids.size(), results.data());
+
+        counts.clear();
+        engine::bitboard_solver bbs;
+        for (const engine::board::grid_t& g : puzzles) {
+            bbs.reset(g);
+            counts.push_back(bbs.count_solutions(100));
+            grids.push_back(bbs.get_grid());
+        }
+        bbs.reset(engine::board().grid());
+        counts.push_back(bbs.count_solutions(100));
+        grids.push_back(bbs.get_grid());
+    };
+
+    engine::details::force_isa_level(engine::details::isa_level::GENERIC);
+    EXPECTED(engine::details::active_isa_level() == engine::details::isa_level::GENERIC);
+    std::vector<engine::board::grid_t> etalon_grids;
+    std::vector<engine::search_result> etalon_results;
+    std::vector<size_t> etalon_counts;
+    run_fn(etalon_grids, etalon_results, etalon_counts);
+    EXPECTED(etalon_counts.back() == 100 && etalon_counts[etalon_counts.size() - 2] == 0);
+
+    const engine::details::isa_level cpu_level = engine::details::cpu_features::get().level();
+    for (size_t l = 0; l <= static_cast<size_t>(cpu_level); ++l) {
+        const engine::details::isa_level level = static_cast<engine::details::isa_level>(l);
+        engine::details::force_isa_level(level);
+        EXPECTED(engine::details::active_isa_level() == level);
+
+        std::vector<engine::board::grid_t> grids;
+        std::vector<engine::search_result> results;
+        std::vector<size_t> counts;
+        run_fn(grids, results, counts);
+        EXPECTED(grids == etalon_grids) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
+        EXPECTED(results == etalon_results) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
+        EXPECTED(counts == etalon_counts) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
     }
+    engine::details::reset_isa_level();
+    EXPECTED(engine::details::active_isa_level() == cpu_level);
 }
 
 int main()
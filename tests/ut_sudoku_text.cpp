@@ -0,0 +1,169 @@
+#include <string>
+#include <vector>
+
+#include "engine/board.h"
+#include "engine/generator.h"
+#include "engine/text.h"
+#include "engine/details/cpu_dispatch.h"
+
+#include "fixtures.h"
+#include "testdefs.h"
+
+using tests::print;
+
+namespace {
+
+const engine::board::grid_t td = {
+    {{3, 0, 6, 5, 0, 8, 4, 0, 0},
+     {5, 2, 0, 0, 0, 0, 0, 0, 0},
+     {0, 8, 7, 0, 0, 0, 0, 3, 1},
+     {0, 0, 3, 0, 1, 0, 0, 8, 0},
+     {9, 0, 0, 8, 6, 3, 0, 0, 5},
+     {0, 5, 0, 0, 9, 0, 6, 0, 0},
+     {1, 3, 0, 0, 0, 0, 2, 5, 0},
+     {0, 0, 0, 0, 0, 0, 0, 7, 4},
+     {0, 0, 5, 2, 0, 6, 3, 0, 0}}
+};
+
+const std::string td_line =
+    "306508400520000000087000031003010080900863005050090600130000250000000074005206300";
+
+} // <anonymous> namespace
+
+TEST(sudoku_text, format)
+{
+    EXPECTED(engine::text::format(td) == td_line) << engine::text::format(td) << std::endl;
+
+    std::string dots = td_line;
+    for (char& ch : dots) {
+        ch = (ch == '0') ? '.' : ch;
+    }
+    EXPECTED(engine::text::format(td, '.') == dots) << engine::text::format(td, '.') << std::endl;
+}
+
+TEST(sudoku_text, parse)
+{
+    engine::board::grid_t g;
+    engine::text::parse_result res = engine::text::parse(td_line, g);
+    EXPECTED(res.code == engine::text::error::NONE) << engine::text::error_to_str(res.code) << std::endl;
+    EXPECTED(g == td) << "Parsed grid:" << std::endl << print(g) << std::endl;
+
+    std::string dots = engine::text::format(td, '.');
+    res = engine::text::parse(dots, g);
+    EXPECTED(res.code == engine::text::error::NONE);
+    EXPECTED(g == td);
+
+    for (size_t i = 0; i < 8; ++i) {
+        const engine::board::grid_t grid = engine::generator::generate_grid();
+        EXPECTED(engine::text::parse(engine::text::format(grid), g).code == engine::text::error::NONE);
+        EXPECTED(g == grid);
+    }
+}
+
+TEST(sudoku_text, parse_errors)
+{
+    engine::board::grid_t g = td;
+    const engine::board::grid_t etalon = g;
+
+    engine::text::parse_result res = engine::text::parse(td_line.substr(0, 80), g);
+    EXPECTED(res.code == engine::text::error::SHORT_LINE && res.offset == 80)
+        << engine::text::error_to_str(res.code) << ", offset: " << res.offset << std::endl;
+
+    res = engine::text::parse(td_line + "1", g);
+    EXPECTED(res.code == engine::text::error::LONG_LINE && res.offset == 81)
+        << engine::text::error_to_str(res.code) << ", offset: " << res.offset << std::endl;
+
+    // Every position, so both the vector blocks and the scalar tail report the offset.
+    for (size_t p = 0; p < engine::text::LINE_SIZE; ++p) {
+        for (const char bad : {'x', '/', ':', ' ', '\0'}) {
+            std::string line = td_line;
+            line[p] = bad;
+            res = engine::text::parse(line, g);
+            EXPECTED(res.code == engine::text::error::BAD_CHAR && res.offset == p)
+                << "char: " << (int)bad << ", " << engine::text::error_to_str(res.code)
+                << ", offset: " << res.offset << ", etalon: " << p << std::endl;
+        }
+    }
+    EXPECTED(g == etalon);
+}
+
+TEST(sudoku_text, parse_lines)
+{
+    std::vector<engine::board::grid_t> grids;
+    std::string buf;
+    for (size_t i = 0; i < 16; ++i) {
+        grids.push_back(engine::generator::generate_grid());
+        buf += engine::text::format(grids.back());
+        buf += (i % 2 == 0) ? "\n" : "\r\n\n";
+    }
+
+    std::vector<engine::board::grid_t> parsed;
+    engine::text::parse_result res = engine::text::parse_lines(buf, parsed);
+    EXPECTED(res.code == engine::text::error::NONE) << engine::text::error_to_str(res.code) << std::endl;
+    EXPECTED(res.lines == grids.size());
+    EXPECTED(parsed == grids);
+
+    // The last line has no newline.
+    parsed.clear();
+    res = engine::text::parse_lines(td_line + "\n" + td_line, parsed);
+    EXPECTED(res.code == engine::text::error::NONE && parsed.size() == 2);
+
+    parsed.clear();
+    const std::string bad = td_line + "\n" + td_line.substr(0, 40) + "?" + td_line.substr(41) + "\n";
+    res = engine::text::parse_lines(bad, parsed);
+    EXPECTED(res.code == engine::text::error::BAD_CHAR);
+    EXPECTED(res.offset == engine::text::LINE_SIZE + 1 + 40) << "offset: " << res.offset << std::endl;
+    EXPECTED(res.lines == 1 && parsed.size() == 1);
+}
+
+TEST(sudoku_text, isa_levels)
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < 8; ++i) {
+        lines.push_back(engine::text::format(engine::generator::generate_grid(), (i % 2 == 0) ? '0' : '.'));
+    }
+    for (size_t p = 0; p < engine::text::LINE_SIZE; ++p) {
+        lines.push_back(td_line);
+        lines.back()[p] = (p % 2 == 0) ? 'x' : '\0';
+    }
+
+    // Every kernel build the CPU can run gives the results of the generic one.
+    const auto run_fn = [&lines](std::vector<engine::board::grid_t>& grids, std::vector<size_t>& offsets,
+                                 std::string& formatted) -> void {
+        grids.clear();
+        offsets.clear();
+        formatted.clear();
+        for (const std::string& line : lines) {
+            engine::board::grid_t g = td;
+            offsets.push_back(engine::text::parse(line, g).offset);
+            grids.push_back(g);
+            formatted += engine::text::format(g, '.');
+        }
+    };
+
+    engine::details::force_isa_level(engine::details::isa_level::GENERIC);
+    std::vector<engine::board::grid_t> etalon_grids;
+    std::vector<size_t> etalon_offsets;
+    std::string etalon_formatted;
+    run_fn(etalon_grids, etalon_offsets, etalon_formatted);
+
+    const engine::details::isa_level cpu_level = engine::details::cpu_features::get().level();
+    for (size_t l = 0; l <= static_cast<size_t>(cpu_level); ++l) {
+        const engine::details::isa_level level = static_cast<engine::details::isa_level>(l);
+        engine::details::force_isa_level(level);
+
+        std::vector<engine::board::grid_t> grids;
+        std::vector<size_t> offsets;
+        std::string formatted;
+        run_fn(grids, offsets, formatted);
+        EXPECTED(grids == etalon_grids) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
+        EXPECTED(offsets == etalon_offsets) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
+        EXPECTED(formatted == etalon_formatted) << "level: " << engine::details::isa_level_to_str(level) << std::endl;
+    }
+    engine::details::reset_isa_level();
+}
+
+int main()
+{
+    return RUN_TESTS();
+}
@@ -1,12 +1,18 @@
-#include <sstream>
+#include <algorithm>
 #include <string>
 
 #include "engine/board.h"
 #include "engine/solver.h"
+#include "engine/details/nogood_store.h"
+#include "engine/details/tables.h"
+#include "engine/details/techniques.h"
 #include "engine/details/utils.h"
 
+#include "fixtures.h"
 #include "testdefs.h"
 
+using tests::print;
+
 namespace {
 
 const engine::board::grid_t td_1 = {
@@ -52,18 +58,6 @@ bool mark_naked_pairs(engine::board& b)
     return engine::details::mark_naked_pairs(b, engine::board::BEGIN_TAG);
 }
 
-std::string print(const engine::board::grid_t& board)
-{
-    std::stringstream ss;
-    for (size_t i = 0; i < board.size(); ++i) {
-        for (size_t j = 0; j < board[i].size(); ++j) {
-            ss << (size_t)board[i][j] << " ";
-        }
-        ss << std::endl;
-    }
-    return ss.str();
-}
-
 bool solve_single_cell(engine::board& b)
 {
     return engine::details::solve_single_cell(b, engine::board::BEGIN_TAG);
@@ -113,6 +107,57 @@ TEST(sudoku_utils, row_by_position)
     }
 }
 
+TEST(sudoku_utils, cell_box)
+{
+    for (size_t i = 0; i < 9; ++i) {
+        for (size_t j = 0; j < 9; ++j) {
+            const size_t pos = i * 9 + j;
+            const size_t box = (i / 3) * 3 + j / 3;
+            EXPECTED(engine::details::CELL_BOX[pos] == box)
+                << "position " << pos << " not equal " << box << " box" << std::endl;
+        }
+    }
+}
+
+TEST(sudoku_utils, unit_cells)
+{
+    for (size_t u = 0; u < engine::details::UNITS_COUNT; ++u) {
+        for (const engine::details::cell_idx_t p : engine::details::UNIT_CELLS[u]) {
+            const engine::details::cell_units_t& units = engine::details::CELL_UNITS[p];
+            EXPECTED(std::find(units.cbegin(), units.cend(), u) != units.cend())
+                << "position " << (size_t)p << " not in unit " << u << std::endl;
+        }
+    }
+    for (size_t i = 0; i < 9; ++i) {
+        EXPECTED(engine::details::UNIT_CELLS[engine::details::ROW_UNIT_BEGIN + 4][i] == 4 * 9 + i);
+        EXPECTED(engine::details::UNIT_CELLS[engine::details::COL_UNIT_BEGIN + 4][i] == i * 9 + 4);
+    }
+    const engine::details::unit_cells_t etalon = {{30, 31, 32, 39, 40, 41, 48, 49, 50}};
+    EXPECTED(engine::details::UNIT_CELLS[engine::details::BOX_UNIT_BEGIN + 4] == etalon);
+}
+
+TEST(sudoku_utils, peers)
+{
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        const engine::details::peers_t& peers = engine::details::PEERS[p];
+        const engine::details::cell_mask_t& mask = engine::details::PEER_MASKS[p];
+
+        size_t mask_count = 0;
+        for (size_t peer = 0; peer < engine::board::BOARD_SIZE; ++peer) {
+            const bool is_peer = (peer != p) &&
+                                 ((engine::details::CELL_ROW[peer] == engine::details::CELL_ROW[p]) ||
+                                  (engine::details::CELL_COL[peer] == engine::details::CELL_COL[p]) ||
+                                  (engine::details::CELL_BOX[peer] == engine::details::CELL_BOX[p]));
+            const bool is_listed = (std::find(peers.cbegin(), peers.cend(), peer) != peers.cend());
+            EXPECTED(is_peer == is_listed) << "position " << p << " peer " << peer << std::endl;
+            EXPECTED(is_peer == engine::details::is_in_mask(mask, peer))
+                << "position " << p << " peer " << peer << std::endl;
+            mask_count += engine::details::is_in_mask(mask, peer) ? 1 : 0;
+        }
+        EXPECTED(mask_count == engine::details::PEERS_COUNT);
+    }
+}
+
 TEST(sudoku_utils, mark_hidden_pairs_col)
 {
     using is_possible_fn_t = const std::function<bool(const engine::board&,size_t,size_t,engine::board::value_t)>;
@@ -451,6 +496,70 @@ TEST(sudoku_utils, solve_single_value)
         << "Test result: " << std::endl << print(sb.grid()) << std::endl;
 }
 
+TEST(sudoku_utils, pipeline)
+{
+    using level_t = engine::details::technique_level;
+
+    size_t counts[3] = {0, 0, 0};
+    const auto logger = [&counts](const level_t l, const engine::board::tag_t) -> void {
+        ++counts[static_cast<size_t>(l)];
+    };
+
+    engine::board singles_board(td_2);
+    engine::board subsets_board(td_2);
+    while (engine::details::singles_pipeline::apply(singles_board, engine::board::BEGIN_TAG)) {}
+    while (engine::details::subsets_pipeline::apply(subsets_board, engine::board::BEGIN_TAG, logger)) {}
+
+    EXPECTED(counts[static_cast<size_t>(level_t::EASY)] > 0);
+    for (size_t p = 0; p < engine::board::BOARD_SIZE; ++p) {
+        if (singles_board.is_set_value(p)) {
+            EXPECTED(subsets_board.is_set_value(p)) << "position " << p << std::endl;
+            EXPECTED(subsets_board.value(p) == singles_board.value(p)) << "position " << p << std::endl;
+        }
+    }
+}
+
+TEST(sudoku_utils, nogood_store)
+{
+    using literal_t = engine::details::nogood_store::literal;
+    using status_t = engine::details::nogood_store::status;
+
+    const engine::board root;
+    const literal_t pair[] = {{0, 1}, {1, 2}};
+
+    engine::details::nogood_store disabled;
+    EXPECTED(! disabled.is_enabled());
+    EXPECTED(! disabled.learn(root, pair, 2));
+
+    engine::details::nogood_store store(2);
+    EXPECTED(! store.learn(root, pair, 0));
+    EXPECTED(store.learn(root, pair, 2));
+    EXPECTED(store.size() == 1);
+
+    engine::board b;
+    EXPECTED(store.apply(b, engine::board::BEGIN_TAG) == status_t::NONE);
+    b.set_value(0, 1, engine::board::BEGIN_TAG);
+    EXPECTED(store.apply(b, engine::board::BEGIN_TAG) == status_t::REDUCED);
+    EXPECTED(! b.is_possible(1, 2));
+    b.rollback_to_tag(engine::board::DEFAULT_TAG);
+    b.set_value(0, 1, engine::board::BEGIN_TAG);
+    b.set_value(1, 2, engine::board::BEGIN_TAG);
+    EXPECTED(store.apply(b, engine::board::BEGIN_TAG) == status_t::CONFLICT);
+
+    // Only the first and the last guesses clash, the rest is dropped to fit the nogood.
+    const literal_t guesses[] = {{0, 1}, {39, 2}, {40, 3}, {41, 4}, {42, 5}, {43, 6}, {44, 7}, {48, 8}, {57, 9}, {1, 1}};
+    const size_t guesses_count = sizeof(guesses) / sizeof(guesses[0]);
+    EXPECTED(guesses_count > engine::details::nogood_store::MAX_LITERALS);
+    EXPECTED(store.learn(root, guesses, guesses_count));
+    EXPECTED(store.size() == 2);
+
+    for (size_t i = 2; i < 8; ++i) {
+        const literal_t single[] = {{static_cast<engine::details::cell_idx_t>(i), 3}};
+        EXPECTED(store.learn(root, single, 1));
+        EXPECTED(store.size() == store.capacity()) << "size: " << store.size() << std::endl;
+    }
+}
+
 int main()
 {
     return RUN_TESTS();
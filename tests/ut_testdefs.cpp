@@ -0,0 +1,57 @@
+#include <cstdint>
+
+#include "testdefs.h"
+
+TEST(testdefs, histogram)
+{
+    tests::histogram empty;
+    EXPECTED(empty.count() == 0 && empty.min() == 0 && empty.percentile(50) == 0);
+
+    // Values below 128 have a bucket each.
+    tests::histogram exact;
+    for (uint64_t v = 1; v <= 100; ++v) {
+        exact.record(v);
+    }
+    EXPECTED(exact.percentile(1) == 1 && exact.percentile(50) == 50 && exact.percentile(100) == 100)
+        << "p1: " << exact.percentile(1) << ", p50: " << exact.percentile(50) << std::endl;
+
+    // 127 is the last exact value, 128 and 129 share a bucket, 255 closes the two wide buckets and
+    // 256 opens the four wide ones.
+    tests::histogram edges;
+    for (const uint64_t v : {127, 128, 255, 256, 1000}) {
+        edges.record(v);
+    }
+    EXPECTED(edges.percentile(20) == 127) << "p20: " << edges.percentile(20) << std::endl;
+    EXPECTED(edges.percentile(40) == 129) << "p40: " << edges.percentile(40) << std::endl;
+    EXPECTED(edges.percentile(60) == 255) << "p60: " << edges.percentile(60) << std::endl;
+    EXPECTED(edges.percentile(80) == 259) << "p80: " << edges.percentile(80) << std::endl;
+    EXPECTED(edges.percentile(100) == 1000) << "p100: " << edges.percentile(100) << std::endl;
+
+    // A larger value keeps the percentile from being clamped to the maximum.
+    for (uint64_t v = 128; v < (uint64_t(1) << 50); v += v / 7 + 3) {
+        tests::histogram h;
+        h.record(v);
+        h.record(2 * v);
+        const uint64_t p = h.percentile(50);
+        EXPECTED(p >= v && (p - v) * tests::histogram::SUB_BUCKETS < v) << "value: " << v << ", p50: " << p << std::endl;
+    }
+
+    tests::histogram merged;
+    merged.record(10);
+    merged.record(20);
+    tests::histogram other;
+    for (const uint64_t v : {30, 40, 1000}) {
+        other.record(v);
+    }
+    merged += other;
+    merged += empty;
+    EXPECTED(merged.count() == 5 && merged.min() == 10 && merged.max() == 1000 && merged.mean() == 220.0)
+        << "count: " << merged.count() << ", min: " << merged.min() << ", mean: " << merged.mean() << std::endl;
+    EXPECTED(merged.percentile(40) == 20 && merged.percentile(60) == 30 && merged.percentile(80) == 40)
+        << "p40: " << merged.percentile(40) << ", p60: " << merged.percentile(60) << std::endl;
+}
+
+int main()
+{
+    return RUN_TESTS();
+}